@@ -0,0 +1,108 @@
+#include "AlgaeField.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+AlgaeField::AlgaeField(int width_)
+    : origin(width_, 0), height(width_, 0), max_height(width_, 0),
+      rooted((width_ + 63) / 64, 0), awake((width_ + 63) / 64, 0) {}
+
+bool AlgaeField::plant(int x, int y, int max_height_) {
+    if (alive(x)) return false;
+    origin[x] = y;
+    height[x] = 1;
+    max_height[x] = max_height_;
+    rooted[x / 64] |= uint64_t(1) << (x % 64);
+    wake(x);
+    return true;
+}
+
+void AlgaeField::set_column(int x, int origin_, int height_, int max_height_) {
+    origin[x] = origin_;
+    height[x] = height_;
+    max_height[x] = max_height_;
+    uint64_t bit = uint64_t(1) << (x % 64);
+    if (height_ > 0) {
+        rooted[x / 64] |= bit;
+        wake(x);
+    } else {
+        rooted[x / 64] &= ~bit;
+        sleep(x);
+    }
+}
+
+void AlgaeField::graze(int x, int y) {
+    if (!covers(x, y)) return;
+    height[x] = origin[x] - y;
+    if (height[x] == 0) {
+        max_height[x] = 0;
+        rooted[x / 64] &= ~(uint64_t(1) << (x % 64));
+        sleep(x);
+    } else {
+        wake(x);
+    }
+}
+
+// Первый столбец с кустом, начиная с x вправо; -1, если такого нет.
+int AlgaeField::next_rooted(int x) const {
+    if (x >= width()) return -1;
+    size_t word = x / 64;
+    uint64_t bits = rooted[word] & (~uint64_t(0) << (x % 64));
+    while (!bits) {
+        if (++word == rooted.size()) return -1;
+        bits = rooted[word];
+    }
+    return static_cast<int>(word * 64 + std::countr_zero(bits));
+}
+
+// Первый столбец с кустом, начиная с x влево; -1, если такого нет.
+int AlgaeField::prev_rooted(int x) const {
+    if (x < 0) return -1;
+    size_t word = x / 64;
+    uint64_t bits = rooted[word] & (~uint64_t(0) >> (63 - x % 64));
+    while (!bits) {
+        if (word-- == 0) return -1;
+        bits = rooted[word];
+    }
+    return static_cast<int>(word * 64 + 63 - std::countl_zero(bits));
+}
+
+// Столбцы перебираются наружу от x, пока смещение по x не превысит
+// лучшее найденное расстояние; в столбце ближайшая клетка — y, прижатый
+// к границам куста.
+bool AlgaeField::find_nearest(int x, int y, int radius, int &found_x, int &found_y) const {
+    int best_dist = radius + 1;
+    found_x = found_y = -1;
+
+    auto consider = [&](int cx) {
+        int cy = std::clamp(y, top(cx), origin[cx]);
+        int d = std::abs(cx - x) + std::abs(cy - y);
+        if (d < best_dist ||
+            (d == best_dist && found_x != -1 &&
+             (cy < found_y || (cy == found_y && cx < found_x)))) {
+            best_dist = d;
+            found_x = cx;
+            found_y = cy;
+        }
+    };
+
+    for (int cx = next_rooted(x); cx != -1 && cx - x <= best_dist; cx = next_rooted(cx + 1))
+        consider(cx);
+    for (int cx = prev_rooted(x - 1); cx != -1 && x - cx <= best_dist; cx = prev_rooted(cx - 1))
+        consider(cx);
+    return found_x != -1;
+}
+
+size_t AlgaeField::plants() const {
+    size_t n = 0;
+    for (uint64_t bits : rooted)
+        n += std::popcount(bits);
+    return n;
+}
+
+size_t AlgaeField::cells() const {
+    size_t n = 0;
+    for (int h : height)
+        n += h;
+    return n;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// Водоросли по столбцам: в столбце x растёт не больше одного куста от
+// origin вверх на height клеток (до max_height). Объектов для отдельных
+// клеток нет, рост и поедание — операции над массивами столбцов.
+class AlgaeField {
+public:
+    explicit AlgaeField(int width_);
+
+    int width() const { return static_cast<int>(origin.size()); }
+    bool alive(int x) const { return height[x] > 0; }
+    bool growing(int x) const { return height[x] < max_height[x]; }
+    int top(int x) const { return origin[x] - height[x] + 1; }
+    bool covers(int x, int y) const { return y <= origin[x] && y > origin[x] - height[x]; }
+
+    // Состояние столбца целиком, для контрольных точек.
+    void get_column(int x, int &origin_, int &height_, int &max_height_) const {
+        origin_ = origin[x];
+        height_ = height[x];
+        max_height_ = max_height[x];
+    }
+    void set_column(int x, int origin_, int height_, int max_height_);
+
+    // Сажает куст высоты 1 в (x, y); false, если в столбце уже есть куст.
+    bool plant(int x, int y, int max_height_);
+    void grow(int x) { ++height[x]; }
+    // Съедена клетка (x, y): всё, что выше неё, тоже пропадает.
+    void graze(int x, int y);
+
+    // Бодрствуют только столбцы, которые могут вырасти в этом тике. Куст,
+    // доросший до max_height или упёршийся во что-то сверху, засыпает и
+    // ничего не стоит, пока его не разбудят посадка, поедание или
+    // освобождение клетки над верхушкой (vacated).
+    void wake(int x) { awake[x / 64] |= uint64_t(1) << (x % 64); }
+    void sleep(int x) { awake[x / 64] &= ~(uint64_t(1) << (x % 64)); }
+    void vacated(int x, int y) {
+        if (growing(x) && y == top(x) - 1) wake(x);
+    }
+
+    // Обходит бодрствующие столбцы в [x0, x1). Разные потоки могут
+    // обходить и усыплять столбцы, если их полосы не делят слов маски.
+    template <class F>
+    void for_each_awake(int x0, int x1, F &&f) {
+        for (int base = x0 & ~63; base < x1; base += 64) {
+            uint64_t bits = awake[base / 64];
+            while (bits) {
+                int x = base + std::countr_zero(bits);
+                bits &= bits - 1;
+                if (x >= x0 && x < x1) f(x);
+            }
+        }
+    }
+
+    // Ближайшая клетка водорослей по манхэттенскому расстоянию, при
+    // равенстве — с меньшими (y, x), как в SpatialIndex::find_nearest.
+    bool find_nearest(int x, int y, int radius, int &found_x, int &found_y) const;
+
+    size_t plants() const;
+    size_t cells() const;
+
+private:
+    std::vector<int> origin, height, max_height;
+    std::vector<uint64_t> rooted;   // бит на столбец с живым кустом
+    std::vector<uint64_t> awake;    // бит на столбец, которому есть что делать
+
+    int next_rooted(int x) const;
+    int prev_rooted(int x) const;
+};
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Счётчик выделений памяти: установившийся тик не должен выделять память.
+// new зовут и потоки пула, поэтому счётчик атомарный; порядок не нужен.
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static long peak_rss_kb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+    return static_cast<long>(pmc.PeakWorkingSetSize / 1024);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+struct Config {
+    int width, height;
+    double density;
+};
+
+struct Options {
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    double seconds = 1.0;
+    int warmup = 20;
+    int max_side = 4096;
+    uint64_t seed = 1;
+    GridLayout layout = LAYOUT_ROWS;
+    // Больше нуля — вместо замера проверить, что столько тиков после
+    // прогрева не выделяют память.
+    long check_allocs = 0;
+};
+
+static Options parse(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--threads")) opt.threads = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--seconds")) opt.seconds = std::atof(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--warmup")) opt.warmup = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--max-side")) opt.max_side = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--seed")) opt.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--check-allocs")) opt.check_allocs = std::atol(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--layout")) {
+            if (!parse_layout(argv[i + 1], opt.layout)) {
+                std::fprintf(stderr, "unknown layout %s, expected rows or morton\n", argv[i + 1]);
+                std::exit(1);
+            }
+        }
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            std::exit(1);
+        }
+    }
+    if (opt.threads < 1) opt.threads = 1;
+    return opt;
+}
+
+// По умолчанию водоросли и рыбы появляются только первые 100 и 150
+// тиков, и к тику 200-900 мир любого размера вымирает: замер мерил бы
+// пустой океан. Здесь появление не кончается, а хищник появляется каждый
+// тик и не даёт травоядным выесть все водоросли, так что численность
+// держится десятки тысяч тиков.
+static Params bench_params() {
+    Params params;
+    params.algae_spawn_until = INT_MAX;
+    params.fish_spawn_until = INT_MAX;
+    params.algae_spawn = 100;
+    params.predator_spawn = 100;
+    return params;
+}
+
+static void populate(Simulation &sim, const Config &cfg) {
+    long water = static_cast<long>(cfg.width) * (cfg.height - 5);
+    int fish = static_cast<int>(water * cfg.density);
+    // Куст в столбце один, так что корма больше, чем по попытке посадки на
+    // столбец, не дать.
+    sim.populate(cfg.width, fish - fish / 5, fish / 5);
+}
+
+// Считаются только тики живого мира: если рыбы или водоросли вымерли до
+// конца окна, проверка не пройдена, даже без выделений.
+static bool check_allocs(const Config &cfg, const Options &opt) {
+    Simulation sim(cfg.width, cfg.height, opt.seed, opt.threads, bench_params(), opt.layout);
+    populate(sim, cfg);
+    for (int i = 0; i < opt.warmup; ++i)
+        sim.update();
+
+    size_t allocs_before = allocations.load();
+    long ticks = 0;
+    while (ticks < opt.check_allocs && sim.get_pools().live() > 0 && sim.get_algae().plants() > 0) {
+        sim.update();
+        ++ticks;
+    }
+    size_t allocs = allocations.load() - allocs_before;
+    bool alive = ticks == opt.check_allocs;
+    std::printf("%dx%d density %g: %zu allocations in %ld ticks after %d warmup ticks%s\n", cfg.width, cfg.height,
+                cfg.density, allocs, ticks, opt.warmup, alive ? "" : ", population died out");
+    std::fflush(stdout);
+    return alive && allocs == 0;
+}
+
+// Размеры идут по возрастанию, поэтому пиковый RSS процесса после
+// каждого прогона приблизительно равен пику этого прогона.
+static void run(const Config &cfg, const Options &opt, bool first) {
+    Simulation sim(cfg.width, cfg.height, opt.seed, opt.threads, bench_params(), opt.layout);
+    populate(sim, cfg);
+
+    for (int i = 0; i < opt.warmup; ++i)
+        sim.update();
+
+    // Если рыбы всё же вымрут, часы останавливаются: дальше шли бы тики
+    // пустого мира.
+    using clock = std::chrono::steady_clock;
+    size_t allocs_before = allocations.load();
+    long ticks = 0;
+    double updates = 0;
+    bool collapsed = false;
+    auto start = clock::now();
+    double elapsed = 0;
+    do {
+        if (sim.get_pools().live() == 0) {
+            collapsed = true;
+            break;
+        }
+        updates += sim.get_pools().live() + sim.get_algae().plants();
+        sim.update();
+        ++ticks;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < opt.seconds || ticks < 3);
+    size_t allocs = allocations.load() - allocs_before;
+
+    const EntityPools &pools = sim.get_pools();
+    char per_entity[32] = "null";
+    if (updates > 0)
+        std::snprintf(per_entity, sizeof(per_entity), "%.3f", elapsed * 1e9 / updates);
+    char per_tick[32] = "null";
+    if (ticks > 0)
+        std::snprintf(per_tick, sizeof(per_tick), "%.3f", ticks / elapsed);
+    std::printf("%s\n    {\"width\": %d, \"height\": %d, \"density\": %g, \"ticks\": %ld, "
+                "\"seconds\": %.6f, \"ticks_per_sec\": %s, \"ns_per_entity_update\": %s, "
+                "\"collapsed\": %s, \"entities\": %zu, \"algae\": %zu, \"herbivores\": %zu, \"predators\": %zu, "
+                "\"allocs_per_tick\": %.3f, \"peak_rss_kb\": %ld}",
+                first ? "" : ",", cfg.width, cfg.height, cfg.density, ticks,
+                elapsed, per_tick, per_entity, collapsed ? "true" : "false",
+                pools.live() + sim.get_algae().plants(), sim.get_algae().cells(), pools.herbivores.live(), pools.predators.live(),
+                ticks > 0 ? static_cast<double>(allocs) / ticks : 0.0, peak_rss_kb());
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    Options opt = parse(argc, argv);
+
+    const int sizes[][2] = {{50, 30}, {240, 40}, {512, 512}, {1024, 1024}, {2048, 2048}, {4096, 4096}};
+    const double densities[] = {0.0, 0.001, 0.01, 0.05};
+
+    std::vector<Config> configs;
+    for (auto& size : sizes) {
+        if (size[0] > opt.max_side || size[1] > opt.max_side) continue;
+        for (double density : densities)
+            configs.push_back({size[0], size[1], density});
+    }
+
+    if (opt.check_allocs > 0) {
+        int failed = 0;
+        // Без рыб с самого начала мир тысячи тиков заселяется до равновесия
+        // и пулы законно растут; засеянный мир начинает выше равновесия.
+        for (const Config &cfg : configs)
+            if (cfg.density > 0) failed += !check_allocs(cfg, opt);
+        return failed ? 1 : 0;
+    }
+
+    std::printf("{\n  \"benchmark\": \"OceanSimBench\",\n  \"threads\": %d,\n  \"seed\": %llu,\n"
+                "  \"layout\": \"%s\",\n  \"warmup_ticks\": %d,\n  \"results\": [",
+                opt.threads, static_cast<unsigned long long>(opt.seed), layout_name(opt.layout), opt.warmup);
+    for (size_t i = 0; i < configs.size(); ++i)
+        run(configs[i], opt, i == 0);
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,236 @@
+#include "Simulation.h"
+#include "Checkpoint.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace checkpoint;
+
+namespace {
+
+template <class T>
+bool write(std::FILE* f, const T &value) {
+    return std::fwrite(&value, sizeof(T), 1, f) == 1;
+}
+
+// Сбрасывает данные на диск до rename, чтобы после сбоя не остался
+// переименованный, но пустой файл.
+bool flush(std::FILE* f) {
+    if (std::fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+ParamsRecord to_record(const Params &p) {
+    ParamsRecord r;
+    r.herbivore_hunger = p.herbivore_hunger;
+    r.predator_hunger = p.predator_hunger;
+    r.herbivore_meal = p.herbivore_meal;
+    r.predator_rest = p.predator_rest;
+    r.predator_rest_range = p.predator_rest_range;
+    r.algae_height = p.algae_height;
+    r.algae_height_range = p.algae_height_range;
+    r.algae_spawn = p.algae_spawn;
+    r.herbivore_spawn = p.herbivore_spawn;
+    r.predator_spawn = p.predator_spawn;
+    r.algae_spawn_until = p.algae_spawn_until;
+    r.fish_spawn_until = p.fish_spawn_until;
+    r.initial_algae = p.initial_algae;
+    r.initial_herbivores = p.initial_herbivores;
+    r.initial_predators = p.initial_predators;
+    r.seabed_depth = p.seabed_depth;
+    return r;
+}
+
+Params from_record(const ParamsRecord &r) {
+    Params p;
+    p.herbivore_hunger = r.herbivore_hunger;
+    p.predator_hunger = r.predator_hunger;
+    p.herbivore_meal = r.herbivore_meal;
+    p.predator_rest = r.predator_rest;
+    p.predator_rest_range = r.predator_rest_range;
+    p.algae_height = r.algae_height;
+    p.algae_height_range = r.algae_height_range;
+    p.algae_spawn = r.algae_spawn;
+    p.herbivore_spawn = r.herbivore_spawn;
+    p.predator_spawn = r.predator_spawn;
+    p.algae_spawn_until = r.algae_spawn_until;
+    p.fish_spawn_until = r.fish_spawn_until;
+    p.initial_algae = r.initial_algae;
+    p.initial_herbivores = r.initial_herbivores;
+    p.initial_predators = r.initial_predators;
+    p.seabed_depth = r.seabed_depth;
+    return p;
+}
+
+// Цель рыбы — клетка мира или (-1, -1): соседей цели читают без проверок.
+bool valid_target(const EntityGrid &grid, int x, int y) {
+    return (x == -1 && y == -1) || grid.in_bounds(x, y);
+}
+
+template <class T>
+T read(const unsigned char* &at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    at += sizeof(T);
+    return value;
+}
+
+}
+
+bool Simulation::save(const std::string &path) const {
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byte_order = byte_order;
+    header.width = width;
+    header.height = height;
+    header.seed = rng.get_seed();
+    header.tick = tick_count;
+    header.next_id = next_id;
+    header.init_draws = init_draws;
+    header.herbivores = static_cast<uint32_t>(pools.herbivores.live());
+    header.predators = static_cast<uint32_t>(pools.predators.live());
+
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+
+    bool ok = write(f, header) && write(f, to_record(params));
+    for (int x = 0; ok && x < width; ++x) {
+        Column c{};
+        c.seabed = terrain.seabed(x);
+        algae.get_column(x, c.origin, c.height, c.max_height);
+        ok = write(f, c);
+    }
+    for (const HerbivoreFish* e : pools.herbivores.objects()) {
+        if (!ok) break;
+        HerbivoreRecord r{};
+        r.x = e->x;
+        r.y = e->y;
+        r.id = e->id;
+        r.hunger = e->hunger;
+        r.target_x = e->target_x;
+        r.target_y = e->target_y;
+        r.just_born = e->just_born;
+        r.just_created = e->just_created;
+        ok = write(f, r);
+    }
+    for (const PredatorFish* e : pools.predators.objects()) {
+        if (!ok) break;
+        PredatorRecord r{};
+        r.x = e->x;
+        r.y = e->y;
+        r.id = e->id;
+        r.hunger = e->hunger;
+        r.target_x = e->target_x;
+        r.target_y = e->target_y;
+        r.wander_timer = e->wander_timer;
+        r.chasing = e->chasing;
+        r.just_born = e->just_born;
+        r.just_created = e->just_created;
+        ok = write(f, r);
+    }
+    ok = ok && flush(f);
+    ok = (std::fclose(f) == 0) && ok;
+
+    std::error_code error;
+    if (ok) std::filesystem::rename(tmp, path, error);
+    if (!ok || error) {
+        std::filesystem::remove(tmp, error);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Simulation> Simulation::load(const std::string &path, int threads, GridLayout layout) {
+    MappedFile file(path);
+    if (!file.data() || file.size() < sizeof(Header)) return nullptr;
+
+    const unsigned char* at = file.data();
+    Header header = read<Header>(at);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.version < 1 || header.version > version || header.byte_order != byte_order ||
+        header.width <= 0 || header.height <= 0)
+        return nullptr;
+
+    size_t params_size = header.version >= 2 ? sizeof(ParamsRecord) : 0;
+    size_t expected = sizeof(Header) + params_size + sizeof(Column) * static_cast<size_t>(header.width) +
+                      sizeof(HerbivoreRecord) * static_cast<size_t>(header.herbivores) +
+                      sizeof(PredatorRecord) * static_cast<size_t>(header.predators);
+    if (file.size() != expected) return nullptr;
+
+    Params params;
+    if (header.version >= 2) params = from_record(read<ParamsRecord>(at));
+    std::string error;
+    if (!params_valid(params) || !world_valid(header.width, header.height, params, error)) return nullptr;
+
+    // Дно от 0 до height: клетка над ним, seabed - 1, остаётся в рамке сетки.
+    std::vector<Column> columns(header.width);
+    std::vector<int> seabed(header.width);
+    for (int x = 0; x < header.width; ++x) {
+        columns[x] = read<Column>(at);
+        if (columns[x].seabed < 0 || columns[x].seabed > header.height) return nullptr;
+        seabed[x] = columns[x].seabed;
+    }
+
+    std::unique_ptr<Simulation> sim(new Simulation(header.width, header.height, header.seed,
+                                                   threads, params, layout, Terrain(std::move(seabed))));
+    sim->tick_count = header.tick;
+    sim->next_id = header.next_id;
+    sim->init_draws = header.init_draws;
+    for (int x = 0; x < header.width; ++x) {
+        // Куст не выше своего предела и целиком в воде над песком; у
+        // пустого столбца предел нулевой, как после graze, иначе его
+        // разбудил бы vacated.
+        const Column &c = columns[x];
+        if (c.height < 0 || c.height > c.max_height || (c.height == 0 && c.max_height != 0))
+            return nullptr;
+        if (c.height > 0 && (c.origin - c.height + 1 < 0 || c.origin >= header.height ||
+                             c.origin >= c.seabed))
+            return nullptr;
+        sim->algae.set_column(x, c.origin, c.height, c.max_height);
+        for (int y = c.origin - c.height + 1; y <= c.origin; ++y)
+            sim->grid.set(x, y, ALGAE);
+    }
+
+    for (uint32_t i = 0; i < header.herbivores; ++i) {
+        HerbivoreRecord r = read<HerbivoreRecord>(at);
+        if (!sim->grid.in_bounds(r.x, r.y) || sim->grid(r.x, r.y) != EMPTY ||
+            !valid_target(sim->grid, r.target_x, r.target_y))
+            return nullptr;
+        HerbivoreFish* e = sim->pools.herbivores.create(r.x, r.y, r.hunger);
+        e->id = r.id;
+        e->target_x = r.target_x;
+        e->target_y = r.target_y;
+        e->just_born = r.just_born;
+        e->just_created = r.just_created;
+        sim->insert(e);
+    }
+    for (uint32_t i = 0; i < header.predators; ++i) {
+        PredatorRecord r = read<PredatorRecord>(at);
+        if (!sim->grid.in_bounds(r.x, r.y) || sim->grid(r.x, r.y) != EMPTY ||
+            !valid_target(sim->grid, r.target_x, r.target_y))
+            return nullptr;
+        PredatorFish* e = sim->pools.predators.create(r.x, r.y, r.hunger);
+        e->id = r.id;
+        e->target_x = r.target_x;
+        e->target_y = r.target_y;
+        e->wander_timer = r.wander_timer;
+        e->chasing = r.chasing;
+        e->just_born = r.just_born;
+        e->just_created = r.just_created;
+        sim->insert(e);
+    }
+    return sim;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+
+// Формат файла контрольной точки Simulation, версия 2. Порядок байт —
+// машины, которая писала (byte_order), поля фиксированной ширины:
+//
+//     Header
+//     ParamsRecord               с версии 2; в версии 1 параметры по умолчанию
+//     Column[width]              рельеф и водоросли по столбцам
+//     HerbivoreRecord[herbivores] в порядке списка пула
+//     PredatorRecord[predators]   в порядке списка пула
+//
+// Сетка и индекс не хранятся: они восстанавливаются по координатам рыб.
+// ГПСЧ счётный, поэтому от него достаточно seed.
+namespace checkpoint {
+
+constexpr char magic[8] = {'O', 'C', 'E', 'A', 'N', 'C', 'K', 'P'};
+constexpr uint32_t version = 2;
+constexpr uint32_t byte_order = 0x01020304;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    int32_t width, height;
+    uint64_t seed;
+    int32_t tick;
+    uint32_t next_id;
+    uint32_t init_draws;
+    uint32_t herbivores;
+    uint32_t predators;
+    uint32_t reserved;
+};
+
+struct ParamsRecord {
+    int32_t herbivore_hunger, predator_hunger, herbivore_meal;
+    int32_t predator_rest, predator_rest_range;
+    int32_t algae_height, algae_height_range;
+    int32_t algae_spawn, herbivore_spawn, predator_spawn;
+    int32_t algae_spawn_until, fish_spawn_until;
+    int32_t initial_algae, initial_herbivores, initial_predators;
+    int32_t seabed_depth;
+};
+
+struct Column {
+    int32_t seabed;
+    int32_t origin, height, max_height;
+};
+
+struct HerbivoreRecord {
+    int32_t x, y;
+    uint32_t id;
+    int32_t hunger;
+    int32_t target_x, target_y;
+    uint8_t just_born, just_created;
+    uint8_t reserved[2];
+};
+
+struct PredatorRecord {
+    int32_t x, y;
+    uint32_t id;
+    int32_t hunger;
+    int32_t target_x, target_y;
+    int32_t wander_timer;
+    uint8_t chasing, just_born, just_created;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(Header) == 56);
+static_assert(sizeof(ParamsRecord) == 64);
+static_assert(sizeof(Column) == 16);
+static_assert(sizeof(HerbivoreRecord) == 28);
+static_assert(sizeof(PredatorRecord) == 32);
+
+}
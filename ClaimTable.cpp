@@ -0,0 +1,37 @@
+#include "ClaimTable.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+void ClaimTable::reset(size_t expected) {
+    size_t size = std::bit_ceil(std::max<size_t>(2 * expected, 64));
+    if (slots.size() < size) slots.resize(size);
+    mask = size - 1;
+    shift = 64 - std::countr_zero(size);
+    std::fill(slots.begin(), slots.begin() + size, Slot{no_cell, no_key});
+}
+
+void ClaimTable::claim(uint64_t cell, uint32_t key) {
+    for (size_t i = home(cell);; i = (i + 1) & mask) {
+        std::atomic_ref<uint64_t> owner(slots[i].cell);
+        uint64_t current = owner.load(std::memory_order_relaxed);
+        if (current == no_cell &&
+            owner.compare_exchange_strong(current, cell, std::memory_order_relaxed))
+            current = cell;
+        if (current != cell) continue;
+
+        std::atomic_ref<uint32_t> best(slots[i].key);
+        uint32_t seen = best.load(std::memory_order_relaxed);
+        while (key < seen &&
+               !best.compare_exchange_weak(seen, key, std::memory_order_relaxed)) {
+        }
+        return;
+    }
+}
+
+bool ClaimTable::won(uint64_t cell, uint32_t key) const {
+    for (size_t i = home(cell);; i = (i + 1) & mask) {
+        if (slots[i].cell == cell) return slots[i].key == key;
+        if (slots[i].cell == no_cell) return false;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Заявки на клетки в тике: открытая адресация по номеру клетки, размер
+// по числу заявителей, а не по площади мира. claim() можно вызывать из
+// нескольких потоков; для каждой клетки остаётся наименьший key.
+class ClaimTable {
+public:
+    // Готовит пустую таблицу минимум на expected заявок.
+    void reset(size_t expected);
+    void claim(uint64_t cell, uint32_t key);
+    // Вызывается после всех claim(), без гонок.
+    bool won(uint64_t cell, uint32_t key) const;
+
+private:
+    static constexpr uint64_t no_cell = UINT64_MAX;
+    static constexpr uint32_t no_key = UINT32_MAX;
+
+    struct Slot {
+        uint64_t cell;
+        uint32_t key;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    int shift = 64;
+
+    size_t home(uint64_t cell) const {
+        return static_cast<size_t>((cell * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+};
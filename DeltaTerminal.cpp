@@ -0,0 +1,107 @@
+#include "DeltaTerminal.h"
+#include "GlyphRenderer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+DeltaTerminal::DeltaTerminal(int width_, int height_)
+    : width(width_), height(height_),
+      previous(width_, height_, EMPTY) {
+    for (int t = EMPTY; t <= PREDATOR; ++t) {
+        const Glyph &g = glyph_for(static_cast<EntityType>(t));
+        sgr[t] = "\x1b[" + g.foreground.Print(false) + ";" + g.background.Print(true) + "m";
+    }
+    out.reserve(static_cast<size_t>(width) * height * 16);
+
+#ifdef _WIN32
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(console, &mode))
+        SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+}
+
+DeltaTerminal::~DeltaTerminal() {
+    out.clear();
+    out += "\x1b[0m";
+    move_cursor(0, height);
+    flush();
+}
+
+void DeltaTerminal::move_cursor(int x, int y) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "\x1b[%d;%dH", y + 1, x + 1);
+    out.append(buf, n);
+}
+
+void DeltaTerminal::present(const Grid<uint8_t> &cells) {
+    out.clear();
+    if (full_redraw) out += "\x1b[2J";
+
+    int w = std::min(width, cells.width()), h = std::min(height, cells.height());
+    int last = -1;
+    for (int y = 0; y < h; ++y) {
+        auto now = cells.row(y);
+        auto before = previous.row(y);
+        int x = 0;
+        while (x < w) {
+            if (!full_redraw && now[x] == before[x]) {
+                ++x;
+                continue;
+            }
+
+            int end = x + 1;
+            for (int i = end, gap = 0; i < w && gap <= max_gap; ++i) {
+                if (full_redraw || now[i] != before[i]) {
+                    end = i + 1;
+                    gap = 0;
+                } else {
+                    ++gap;
+                }
+            }
+
+            move_cursor(x, y);
+            for (; x < end; ++x) {
+                if (now[x] != last) {
+                    last = now[x];
+                    out += sgr[last];
+                }
+                out += glyph_for(static_cast<EntityType>(now[x])).character;
+            }
+        }
+        std::copy(now.begin(), now.begin() + w, before.begin());
+    }
+
+    if (last != -1 || full_redraw) {
+        out += "\x1b[0m";
+        move_cursor(0, height);
+        flush();
+    }
+
+    full_redraw = false;
+}
+
+void DeltaTerminal::flush() {
+    const char* data = out.data();
+    size_t left = out.size();
+    while (left > 0) {
+#ifdef _WIN32
+        int n = _write(1, data, static_cast<unsigned>(left));
+#else
+        ssize_t n = ::write(STDOUT_FILENO, data, left);
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+}
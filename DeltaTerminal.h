@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Entity.h"
+#include "Grid.h"
+
+// Вывод кадров в терминал разностями: помнит предыдущий кадр и шлёт
+// перемещения курсора и цвета только для изменившихся клеток. Соседние
+// изменения склеиваются в один отрезок, кадр уходит одним вызовом write.
+class DeltaTerminal {
+public:
+    DeltaTerminal(int width_, int height_);
+    ~DeltaTerminal();
+
+    void present(const Grid<uint8_t> &cells);
+    void invalidate() { full_redraw = true; }
+
+private:
+    // Короткий промежуток без изменений дешевле перерисовать, чем
+    // перепрыгнуть новым перемещением курсора.
+    static constexpr int max_gap = 3;
+
+    int width, height;
+    Grid<uint8_t> previous;
+    std::string out;
+    std::string sgr[PREDATOR + 1];
+    bool full_redraw = true;
+
+    void move_cursor(int x, int y);
+    void flush();
+};
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+#include "ThreadPool.h"
+
+// Много независимых океанов без интерфейса: декартово произведение
+// списков параметров, для каждого набора — seeds прогонов с сидами
+// seed, seed+1, ... (одинаковыми для всех наборов). Итог — один CSV со
+// средним, минимумом и максимумом численности по прогонам набора на
+// каждый тик. Не заданные списки берут значение из --config (или по
+// умолчанию).
+
+struct Population {
+    int algae, herbivores, predators;
+
+    bool operator==(const Population &) const = default;
+};
+
+struct Options {
+    int width = 240, height = 40;
+    int ticks = 1000;
+    int seeds = 10;
+    uint64_t seed = 1;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    // Прогон останавливается, если численность не менялась столько тиков
+    // подряд после конца появления новых объектов; 0 — не останавливать.
+    int steady = 100;
+    std::string out = "ensemble.csv";
+    Params base;
+    GridLayout layout = LAYOUT_ROWS;
+    std::vector<int> herbivore_hunger, predator_hunger;
+    std::vector<int> algae_spawn, herbivore_spawn, predator_spawn;
+};
+
+struct Run {
+    Params params;
+    uint64_t seed;
+    // По тику на элемент, начиная с первого; после остановки численность
+    // считается неизменной.
+    std::vector<Population> series;
+};
+
+// Целые через запятую; на мусоре или числе вне int — выход с сообщением.
+static std::vector<int> parse_list(const char* option, const char* arg) {
+    std::vector<int> values;
+    for (const char* p = arg;;) {
+        char* end;
+        long long value = std::strtoll(p, &end, 10);
+        if (end == p || (*end && *end != ',') || value < INT_MIN || value > INT_MAX) {
+            std::fprintf(stderr, "%s: bad list %s\n", option, arg);
+            std::exit(1);
+        }
+        values.push_back(static_cast<int>(value));
+        if (!*end) return values;
+        p = end + 1;
+    }
+}
+
+static Options parse(int argc, char** argv) {
+    Options opt;
+    long long width = opt.width, height = opt.height;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* value = argv[i + 1];
+        if (!std::strcmp(argv[i], "--config")) {
+            Scenario scenario;
+            std::string error;
+            if (!load_scenario(value, scenario, error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                std::exit(1);
+            }
+            width = scenario.width;
+            height = scenario.height;
+            if (scenario.seed) opt.seed = scenario.seed;
+            opt.base = scenario.params;
+            opt.layout = scenario.layout;
+        }
+        else if (!std::strcmp(argv[i], "--width")) width = std::strtoll(value, nullptr, 10);
+        else if (!std::strcmp(argv[i], "--height")) height = std::strtoll(value, nullptr, 10);
+        else if (!std::strcmp(argv[i], "--ticks")) opt.ticks = std::atoi(value);
+        else if (!std::strcmp(argv[i], "--seeds")) opt.seeds = std::atoi(value);
+        else if (!std::strcmp(argv[i], "--seed")) opt.seed = std::strtoull(value, nullptr, 10);
+        else if (!std::strcmp(argv[i], "--threads")) opt.threads = std::atoi(value);
+        else if (!std::strcmp(argv[i], "--steady")) opt.steady = std::atoi(value);
+        else if (!std::strcmp(argv[i], "--out")) opt.out = value;
+        else if (!std::strcmp(argv[i], "--herbivore-hunger")) opt.herbivore_hunger = parse_list(argv[i], value);
+        else if (!std::strcmp(argv[i], "--predator-hunger")) opt.predator_hunger = parse_list(argv[i], value);
+        else if (!std::strcmp(argv[i], "--algae-spawn")) opt.algae_spawn = parse_list(argv[i], value);
+        else if (!std::strcmp(argv[i], "--herbivore-spawn")) opt.herbivore_spawn = parse_list(argv[i], value);
+        else if (!std::strcmp(argv[i], "--predator-spawn")) opt.predator_spawn = parse_list(argv[i], value);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            std::exit(1);
+        }
+    }
+    std::string error;
+    if (!world_valid(width, height, opt.base, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        std::exit(1);
+    }
+    opt.width = static_cast<int>(width);
+    opt.height = static_cast<int>(height);
+    if (opt.threads < 1) opt.threads = 1;
+    if (opt.seeds < 1) opt.seeds = 1;
+    return opt;
+}
+
+static std::vector<Params> configs(const Options &opt) {
+    auto or_base = [](const std::vector<int> &list, int value) {
+        return list.empty() ? std::vector<int>{value} : list;
+    };
+    std::vector<Params> out;
+    for (int hh : or_base(opt.herbivore_hunger, opt.base.herbivore_hunger))
+        for (int ph : or_base(opt.predator_hunger, opt.base.predator_hunger))
+            for (int as : or_base(opt.algae_spawn, opt.base.algae_spawn))
+                for (int hs : or_base(opt.herbivore_spawn, opt.base.herbivore_spawn))
+                    for (int ps : or_base(opt.predator_spawn, opt.base.predator_spawn)) {
+                        Params p = opt.base;
+                        p.herbivore_hunger = hh;
+                        p.predator_hunger = ph;
+                        p.algae_spawn = as;
+                        p.herbivore_spawn = hs;
+                        p.predator_spawn = ps;
+                        out.push_back(p);
+                    }
+    return out;
+}
+
+// Рыбы вымерли или численность застыла — дальше ничего не изменится
+// (или почти ничего), прогон можно не продолжать.
+static void simulate(Run &run, const Options &opt) {
+    Simulation sim(opt.width, opt.height, run.seed, 1, run.params, opt.layout);
+    int quiet_from = std::max(run.params.algae_spawn_until, run.params.fish_spawn_until);
+    int unchanged = 0;
+    run.series.reserve(opt.ticks);
+    for (int t = 0; t < opt.ticks; ++t) {
+        sim.update();
+        const EntityPools &pools = sim.get_pools();
+        Population now{static_cast<int>(sim.get_algae().plants()), static_cast<int>(pools.herbivores.live()),
+                       static_cast<int>(pools.predators.live())};
+        unchanged = !run.series.empty() && run.series.back() == now ? unchanged + 1 : 0;
+        run.series.push_back(now);
+
+        if (sim.get_tick() < quiet_from) continue;
+        if (now.herbivores == 0 && now.predators == 0) break;
+        if (opt.steady > 0 && unchanged >= opt.steady) break;
+    }
+}
+
+static void write_series(std::FILE* out, const Options &opt, const std::vector<Run> &runs, size_t config_count) {
+    std::fprintf(out, "config,herbivore_hunger,predator_hunger,algae_spawn,herbivore_spawn,predator_spawn,tick,running,"
+                      "algae_mean,algae_min,algae_max,herbivores_mean,herbivores_min,herbivores_max,"
+                      "predators_mean,predators_min,predators_max\n");
+    for (size_t c = 0; c < config_count; ++c) {
+        const Run* first = &runs[c * opt.seeds];
+        const Params &p = first->params;
+        for (int t = 0; t < opt.ticks; ++t) {
+            int running = 0;
+            double sum[3] = {};
+            int lo[3] = {}, hi[3] = {};
+            for (int s = 0; s < opt.seeds; ++s) {
+                const std::vector<Population> &series = first[s].series;
+                if (t < static_cast<int>(series.size())) ++running;
+                const Population &pop = series[std::min<size_t>(t, series.size() - 1)];
+                int v[3] = {pop.algae, pop.herbivores, pop.predators};
+                for (int k = 0; k < 3; ++k) {
+                    sum[k] += v[k];
+                    lo[k] = s ? std::min(lo[k], v[k]) : v[k];
+                    hi[k] = s ? std::max(hi[k], v[k]) : v[k];
+                }
+            }
+            std::fprintf(out, "%zu,%d,%d,%d,%d,%d,%d,%d", c, p.herbivore_hunger, p.predator_hunger, p.algae_spawn,
+                         p.herbivore_spawn, p.predator_spawn, t + 1, running);
+            for (int k = 0; k < 3; ++k)
+                std::fprintf(out, ",%.3f,%d,%d", sum[k] / opt.seeds, lo[k], hi[k]);
+            std::fprintf(out, "\n");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt = parse(argc, argv);
+    if (opt.ticks < 1) return 0;
+
+    std::vector<Params> sets = configs(opt);
+    // Значения из списков минуют проверки сценария — проверяем каждый набор.
+    for (const Params &p : sets) {
+        if (!params_valid(p)) {
+            std::fprintf(stderr, "invalid parameters: herbivore_hunger=%d predator_hunger=%d algae_spawn=%d "
+                                 "herbivore_spawn=%d predator_spawn=%d\n",
+                         p.herbivore_hunger, p.predator_hunger, p.algae_spawn, p.herbivore_spawn, p.predator_spawn);
+            return 1;
+        }
+    }
+    std::vector<Run> runs;
+    for (size_t c = 0; c < sets.size(); ++c)
+        for (int s = 0; s < opt.seeds; ++s)
+            runs.push_back({sets[c], opt.seed + s, {}});
+
+    // Прогоны — крупные задания разной длины: пул раздаёт их по одному
+    // из общего счётчика, так что освободившийся поток сразу берёт
+    // следующий, а каждая Simulation работает в один поток.
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(opt.threads);
+    pool.run(static_cast<int>(runs.size()), [&](int i) { simulate(runs[i], opt); });
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::FILE* out = std::fopen(opt.out.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", opt.out.c_str());
+        return 1;
+    }
+    write_series(out, opt, runs, sets.size());
+    std::fclose(out);
+
+    size_t simulated = 0;
+    for (const Run &run : runs)
+        simulated += run.series.size();
+    std::fprintf(stderr, "%zu runs (%zu configs x %d seeds), %zu of %zu ticks simulated, %.2f s on %d threads\n",
+                 runs.size(), sets.size(), opt.seeds, simulated, runs.size() * opt.ticks, elapsed, opt.threads);
+    return 0;
+}
@@ -1,16 +1,76 @@
 #pragma once
-#include <ftxui/dom/elements.hpp>
-#include <vector>
+#include <cstdint>
+#include "AlgaeField.h"
+#include "Params.h"
+#include "Random.h"
+#include "SparseGrid.h"
 
-enum EntityType { EMPTY, SAND, ALGAE, HERBIVORE, PREDATOR };
+enum EntityType : uint8_t { EMPTY, SAND, ALGAE, HERBIVORE, PREDATOR };
 
+class Entity;
+class SpatialIndex;
+// Что лежит в каждой клетке мира, по байту на клетку: рыбы, водоросли и
+// песок (рамка вокруг мира — тоже песок). Сами рыбы — в пулах, в сетке
+// их нет: проверки соседей читают только эту плоскость.
+using EntityGrid = SparseGrid<EntityType>;
+
+enum Action { STAY, MOVE, EAT, GROW, DIE };
+
+// Соседи клетки: вниз, вправо, влево, вверх.
+constexpr int neighbour_dx[4] = {0, 1, -1, 0};
+constexpr int neighbour_dy[4] = {1, 0, 0, -1};
+
+// Намерение объекта на этот тик. MOVE, EAT и GROW претендуют на клетку
+// (to_x, to_y); при конфликте побеждает меньший key. У роста водорослей
+// actor нулевой: столбец задаёт to_x.
+struct Intent {
+    Entity* actor;
+    Action action = STAY;
+    int to_x = -1, to_y = -1;
+    uint32_t key = 0;
+
+    bool claims() const { return action == MOVE || action == EAT || action == GROW; }
+};
+
+struct TickContext {
+    const EntityGrid &grid;
+    const AlgaeField &algae;
+    const SpatialIndex &index;
+    const Rng &rng;
+    const Params &params;
+    int tick;
+
+    uint32_t random(const Entity &e, RandomStream stream, uint32_t n = 0) const;
+    // Клетка в пределах мира, не песок, не водоросли и никем не занята.
+    // (x, y) — клетка мира или её сосед.
+    bool free(int x, int y) const { return grid(x, y) == EMPTY; }
+};
+
+// Общая часть всех объектов. Виртуальных функций нет: каждый вид, который
+// действует, объявляет у себя
+//     template <class P> Intent propose(const TickContext &ctx);
+//         вызывается параллельно, читает только ctx.grid и ctx.index,
+//         меняет только собственное состояние;
+//     template <class P> void resolve(const Intent &intent, bool granted, const TickContext &ctx);
+//         вызывается последовательно при фиксации тика;
+// а Simulation вызывает их напрямую, обходя пул этого вида. Параметры
+// берутся через P::of(ctx) (см. RuntimeParams в Params.h); обе версии
+// инстанцируются явно в файле вида.
 class Entity {
 public:
     int x, y;
     EntityType type;
+    uint32_t id = 0;
     bool to_delete = false;
-    virtual ~Entity() {}
-    virtual void update(const std::vector<std::vector<Entity*>> &grid,
-                        std::vector<std::vector<Entity*>> &new_grid) = 0;
-    virtual ftxui::Element draw() const = 0;
+    // Соседи по корзине SpatialIndex: корзина — список через сами объекты.
+    Entity* bucket_prev = nullptr;
+    Entity* bucket_next = nullptr;
+
+protected:
+    Intent stay() { return {this}; }
+    Intent act(Action action, int to_x, int to_y) { return {this, action, to_x, to_y}; }
 };
+
+inline uint32_t TickContext::random(const Entity &e, RandomStream stream, uint32_t n) const {
+    return rng(tick, e.id, stream, n);
+}
@@ -0,0 +1,18 @@
+#include "EntityPools.h"
+
+void EntityPools::destroy(Entity* e) {
+    switch (e->type) {
+    case HERBIVORE: herbivores.destroy(static_cast<HerbivoreFish*>(e)); break;
+    case PREDATOR: predators.destroy(static_cast<PredatorFish*>(e)); break;
+    default: break;
+    }
+}
+
+void EntityPools::reset() {
+    herbivores.reset();
+    predators.reset();
+}
+
+size_t EntityPools::live() const {
+    return herbivores.live() + predators.live();
+}
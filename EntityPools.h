@@ -0,0 +1,13 @@
+#pragma once
+#include "Pool.h"
+#include "HerbivoreFish.h"
+#include "PredatorFish.h"
+
+struct EntityPools {
+    Pool<HerbivoreFish> herbivores;
+    Pool<PredatorFish> predators;
+
+    void destroy(Entity* e);
+    void reset();
+    size_t live() const;
+};
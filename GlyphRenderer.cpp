@@ -0,0 +1,63 @@
+#include "GlyphRenderer.h"
+#include <ftxui/dom/node.hpp>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+using namespace ftxui;
+
+namespace {
+
+const Glyph glyphs[] = {
+    {" ", Color::Default, Color::NavyBlue},
+    {"█", Color::YellowLight, Color::NavyBlue},
+    {"█", Color::Green3, Color::NavyBlue},
+    {"■", Color::Orange1, Color::NavyBlue},
+    {"■", Color::Red3, Color::NavyBlue},
+};
+
+class GridNode : public Node {
+public:
+    GridNode(const Grid<uint8_t> &cells_, std::atomic<int64_t>* render_ns_) : cells(cells_), render_ns(render_ns_) {}
+
+    void ComputeRequirement() override {
+        requirement_.min_x = cells.width();
+        requirement_.min_y = cells.height();
+    }
+
+    void Render(Screen &screen) override {
+        if (!render_ns) return blit_cells(screen, cells, box_.x_min, box_.y_min);
+        auto start = std::chrono::steady_clock::now();
+        blit_cells(screen, cells, box_.x_min, box_.y_min);
+        *render_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    const Grid<uint8_t> &cells;
+    std::atomic<int64_t>* render_ns;
+};
+
+}
+
+const Glyph &glyph_for(EntityType type) {
+    return glyphs[type];
+}
+
+void blit_cells(Screen &screen, const Grid<uint8_t> &cells, int left, int top) {
+    int w = std::min(cells.width(), screen.dimx() - left);
+    int h = std::min(cells.height(), screen.dimy() - top);
+    for (int y = 0; y < h; ++y) {
+        auto row = cells.row(y);
+        for (int x = 0; x < w; ++x) {
+            const Glyph &g = glyphs[row[x]];
+            Pixel &p = screen.PixelAt(left + x, top + y);
+            p.character = g.character;
+            p.foreground_color = g.foreground;
+            p.background_color = g.background;
+        }
+    }
+}
+
+Element grid_view(const Grid<uint8_t> &cells, std::atomic<int64_t>* render_ns) {
+    return std::make_shared<GridNode>(cells, render_ns);
+}
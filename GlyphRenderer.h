@@ -0,0 +1,25 @@
+#pragma once
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "Entity.h"
+#include "Grid.h"
+
+struct Glyph {
+    std::string character;
+    ftxui::Color foreground;
+    ftxui::Color background;
+};
+
+const Glyph &glyph_for(EntityType type);
+
+// Пишет клетки (EntityType на байт) прямо в пиксели экрана начиная
+// с (left, top), без дерева Element.
+void blit_cells(ftxui::Screen &screen, const Grid<uint8_t> &cells, int left = 0, int top = 0);
+
+// Один узел DOM, который при отрисовке вызывает blit_cells для своей области.
+// Если render_ns задан, время каждой отрисовки в наносекундах прибавляется к
+// нему: так его может забрать другой поток.
+ftxui::Element grid_view(const Grid<uint8_t> &cells, std::atomic<int64_t>* render_ns = nullptr);
@@ -0,0 +1,39 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Прямоугольная сетка в одном непрерывном буфере, построчно.
+template <class T>
+class Grid {
+public:
+    Grid(int width_, int height_)
+        : w(width_), h(height_), cells(static_cast<size_t>(width_) * height_) {}
+    Grid(int width_, int height_, const T &value)
+        : w(width_), h(height_), cells(static_cast<size_t>(width_) * height_, value) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t size() const { return cells.size(); }
+
+    bool in_bounds(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(w) &&
+               static_cast<unsigned>(y) < static_cast<unsigned>(h);
+    }
+
+    T &operator()(int x, int y) { return cells[static_cast<size_t>(y) * w + x]; }
+    const T &operator()(int x, int y) const { return cells[static_cast<size_t>(y) * w + x]; }
+
+    std::span<T> row(int y) { return {cells.data() + static_cast<size_t>(y) * w, static_cast<size_t>(w)}; }
+    std::span<const T> row(int y) const { return {cells.data() + static_cast<size_t>(y) * w, static_cast<size_t>(w)}; }
+
+    T *data() { return cells.data(); }
+    const T *data() const { return cells.data(); }
+
+    void fill(const T &value) { std::fill(cells.begin(), cells.end(), value); }
+
+private:
+    int w, h;
+    std::vector<T> cells;
+};
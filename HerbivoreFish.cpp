@@ -1,119 +1,72 @@
 #include "HerbivoreFish.h"
-#include <cstdlib>
 #include <algorithm>
-#include "Algae.h"
 #include "PredatorFish.h"
-#include <ftxui/dom/elements.hpp>
-using namespace ftxui;
 
-HerbivoreFish::HerbivoreFish(int x_, int y_) {
+HerbivoreFish::HerbivoreFish(int x_, int y_, int hunger_) {
     x = x_;
     y = y_;
+    hunger = hunger_;
     type = HERBIVORE;
     just_born = true;
 }
 
-bool HerbivoreFish::find_nearest_algae(const std::vector<std::vector<Entity*>> &grid) {
-    int best_dist = 9999;
-    for (int yy = 0; yy < grid.size(); ++yy) {
-        for (int xx = 0; xx < grid[0].size(); ++xx) {
-            Entity* e = grid[yy][xx];
-            if (e && e->type == ALGAE && !e->to_delete) {
-                int d = abs(xx - x) + abs(yy - y);
-                if (d < best_dist) {
-                    best_dist = d;
-                    target_x = xx;
-                    target_y = yy;
-                }
-            }
-        }
-    }
-    return target_x != -1;
+bool HerbivoreFish::find_nearest_algae(const EntityGrid &grid, const AlgaeField &algae) {
+    return algae.find_nearest(x, y, grid.width() + grid.height() - 1, target_x, target_y);
 }
 
-void HerbivoreFish::update(const std::vector<std::vector<Entity*>> &grid,
-                           std::vector<std::vector<Entity*>> &new_grid) {
+template <class P>
+Intent HerbivoreFish::propose(const TickContext &ctx) {
+    const EntityGrid &grid = ctx.grid;
+    const Params &params = P::of(ctx);
     if (just_created) {
         just_created = false;
-        new_grid[y][x] = this;
-        return;
+        return stay();
     }
 
-    if (to_delete) return;
-
-    static int dx[] = {0, 1, -1, 0};
-    static int dy[] = {1, 0, 0, -1};
-    int nx = x, ny = y;
-    bool moved = false;
-
-    if (target_x != -1 && target_y != -1) {
-        Entity* t = grid[target_y][target_x];
-        if (!t || t->to_delete || t->type != ALGAE) {
-            target_x = target_y = -1;
-        }
-    }
+    bool has_target = false;
+    if (target_x != -1 && target_y != -1)
+        has_target = grid(target_x, target_y) == ALGAE;
 
-    if (hunger < 15 && target_x == -1) find_nearest_algae(grid);
+    if (hunger < params.herbivore_hunger && !has_target) find_nearest_algae(grid, ctx.algae);
 
     if (target_x != -1 && target_y != -1) {
         int dx_move = (target_x > x) - (target_x < x);
         int dy_move = (target_y > y) - (target_y < y);
 
-        int tx = x + dx_move;
-        int ty = y;
-        if (tx >= 0 && tx < grid[0].size() && ty >= 0 && ty < grid.size()) {
-            Entity* e = grid[ty][tx];
-            if (e && e->type == PREDATOR) { to_delete = true; return; }
-            if (e && e->type == ALGAE) {
-                e->to_delete = true;
-                hunger = std::min(hunger + 2, 15);
-                nx = tx; ny = ty;
-                moved = true;
-            } else if (!e && new_grid[ty][tx] == nullptr) {
-                nx = tx; ny = ty;
-                moved = true;
-            }
+        // Шаг к цели, которая в мире, тоже всегда в мире.
+        int steps[2][2] = {{x + dx_move, y}, {x, y + dy_move}};
+        for (auto& step : steps) {
+            int tx = step[0], ty = step[1];
+            EntityType cell = grid(tx, ty);
+            if (cell == PREDATOR) return act(DIE, x, y);
+            if (cell == ALGAE) return act(EAT, tx, ty);
+            if (cell == EMPTY) return act(MOVE, tx, ty);
         }
 
-        if (!moved) {
-            tx = x;
-            ty = y + dy_move;
-            if (tx >= 0 && tx < grid[0].size() && ty >= 0 && ty < grid.size()) {
-                Entity* e = grid[ty][tx];
-                if (e && e->type == PREDATOR) { to_delete = true; return; }
-                if (e && e->type == ALGAE) {
-                    e->to_delete = true;
-                    hunger = std::min(hunger + 2, 15);
-                    nx = tx; ny = ty;
-                    moved = true;
-                } else if (!e && new_grid[ty][tx] == nullptr) {
-                    nx = tx; ny = ty;
-                    moved = true;
-                }
-            }
-        }
+        target_x = target_y = -1;
     }
 
-    if (!moved) {
-        hunger--;
-        int dir = rand() % 4;
-        int cx = x + dx[dir], cy = y + dy[dir];
-        if (cx >= 0 && cx < grid[0].size() && cy >= 0 && cy < grid.size()) {
-            Entity* occupant = grid[cy][cx];
-            if ((!occupant || occupant->type != PREDATOR) && new_grid[cy][cx] == nullptr) {
-                nx = cx;
-                ny = cy;
-            }
-        }
-    }
+    hunger--;
+    if (hunger <= 0) return act(DIE, x, y);
 
-    if (hunger <= 0) { to_delete = true; return; }
+    int dir = ctx.random(*this, STREAM_WALK) % 4;
+    int cx = x + neighbour_dx[dir], cy = y + neighbour_dy[dir];
+    if (ctx.free(cx, cy))
+        return act(MOVE, cx, cy);
+    return stay();
+}
 
-    new_grid[ny][nx] = this;
-    x = nx; y = ny;
+template <class P>
+void HerbivoreFish::resolve(const Intent &intent, bool granted, const TickContext &ctx) {
+    const Params &params = P::of(ctx);
+    if (intent.action == EAT && granted) {
+        hunger = std::min(hunger + params.herbivore_meal, params.herbivore_hunger);
+        target_x = target_y = -1;
+    }
     just_born = false;
 }
 
-Element HerbivoreFish::draw() const {
-    return text("■") | color(Color::Orange1) | bgcolor(Color::NavyBlue);
-}
+template Intent HerbivoreFish::propose<RuntimeParams>(const TickContext &);
+template Intent HerbivoreFish::propose<DefaultParams>(const TickContext &);
+template void HerbivoreFish::resolve<RuntimeParams>(const Intent &, bool, const TickContext &);
+template void HerbivoreFish::resolve<DefaultParams>(const Intent &, bool, const TickContext &);
@@ -3,16 +3,19 @@
 
 class HerbivoreFish : public Entity {
 public:
-    int hunger = 15;
+    static constexpr EntityType kind = HERBIVORE;
+
+    int hunger;
     int target_x = -1, target_y = -1;
     bool just_born = true;
     bool just_created = false;
 
-    HerbivoreFish(int x_, int y_);
-    void update(const std::vector<std::vector<Entity*>> &grid,
-                std::vector<std::vector<Entity*>> &new_grid) override;
-    ftxui::Element draw() const override;
+    HerbivoreFish(int x_, int y_, int hunger_);
+    template <class P>
+    Intent propose(const TickContext &ctx);
+    template <class P>
+    void resolve(const Intent &intent, bool granted, const TickContext &ctx);
 
 private:
-    bool find_nearest_algae(const std::vector<std::vector<Entity*>> &grid);
+    bool find_nearest_algae(const EntityGrid &grid, const AlgaeField &algae);
 };
@@ -1,40 +1,76 @@
-#include <ftxui/screen/screen.hpp>
-#include <ftxui/screen/color.hpp>
-#include <ftxui/dom/elements.hpp>
-#include <ftxui/screen/string.hpp>
+#include <ftxui/screen/terminal.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <thread>
-#include <chrono>
+#include <cstdio>
+#include <memory>
 #include "Simulation.h"
+#include "DeltaTerminal.h"
+#include "TickScheduler.h"
 
-using namespace ftxui;
+int main(int argc, char** argv) {
+    // OceanSim [--config сценарий] [ширина высота [файл метрик]]: выводится
+    // окно с левого верхнего угла размером не больше терминала.
+    Scenario scenario;
+    scenario.width = 50;
+    scenario.height = 30;
+    scenario.seed = 1;
+    int arg = 1;
+    if (argc > 2 && std::strcmp(argv[1], "--config") == 0) {
+        std::string error;
+        if (!load_scenario(argv[2], scenario, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        arg = 3;
+    }
+    long long size_x = argc > arg + 1 ? std::strtoll(argv[arg], nullptr, 10) : scenario.width;
+    long long size_y = argc > arg + 1 ? std::strtoll(argv[arg + 1], nullptr, 10) : scenario.height;
+    const char* metrics_path = argc > arg + 2 ? argv[arg + 2] : nullptr;
+    std::string error;
+    if (!world_valid(size_x, size_y, scenario.params, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    int width = static_cast<int>(size_x), height = static_cast<int>(size_y);
 
-int main() {
-    constexpr int width = 50;
-    constexpr int height = 30;
+    ftxui::Dimensions term = ftxui::Terminal::Size();
+    int view_width = std::min(width, term.dimx);
+    int view_height = std::min(height, term.dimy);
 
-    Simulation sim(width, height);
+    uint64_t seed = scenario.seed ? scenario.seed : static_cast<uint64_t>(time(NULL));
+    Simulation sim(width, height, seed, std::thread::hardware_concurrency(), scenario.params,
+                   scenario.layout);
+    Snapshot frame(view_width, view_height);
+    DeltaTerminal terminal(view_width, view_height);
 
-    while (true) {
-        sim.update();
-        auto grid = sim.get_grid();
+    std::unique_ptr<Metrics> metrics;
+    if (metrics_path) {
+        metrics = std::make_unique<Metrics>(metrics_path, metrics_format_for(metrics_path),
+                                            scenario.metrics_interval);
+        if (!metrics->is_open()) {
+            std::fprintf(stderr, "cannot write metrics %s\n", metrics_path);
+            return 1;
+        }
+        sim.set_metrics(metrics.get());
+    }
 
-        Elements rows;
-        for (int y = 0; y < height; ++y) {
-            Elements row;
-            for (int x = 0; x < width; ++x) {
-                if (grid[y][x])
-                    row.push_back(grid[y][x]->draw());
-                else
-                    row.push_back(text(" ") | bgcolor(Color::NavyBlue));
+    // 10 тиков в секунду, кадр — с частотой обновления терминала.
+    TickScheduler scheduler(10, 30);
+    while (true) {
+        while (scheduler.tick_due())
+            sim.update();
+        if (scheduler.frame_due()) {
+            {
+                PhaseTimer timer(metrics.get(), PHASE_SNAPSHOT);
+                sim.snapshot(frame);
             }
-            rows.push_back(hbox(std::move(row)));
+            PhaseTimer timer(metrics.get(), PHASE_RENDER);
+            terminal.present(frame.cells);
         }
-
-        auto doc = vbox(std::move(rows));
-        auto screen = Screen::Create(Dimension::Fixed(width), Dimension::Fixed(height));
-        Render(screen, doc);
-        screen.Print();
-        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        scheduler.wait();
     }
     return 0;
 }
@@ -0,0 +1,64 @@
+#include "Metrics.h"
+
+static const char* const phase_names[PHASE_COUNT] = {"propose", "resolve", "remove", "spawn", "snapshot", "render"};
+static const char* const species_names[PREDATOR + 1] = {"empty", "sand", "algae", "herbivore", "predator"};
+static constexpr EntityType species_list[] = {ALGAE, HERBIVORE, PREDATOR};
+
+Metrics::Metrics(const std::string &path, MetricsFormat format_, int interval_)
+    : format(format_), interval(interval_ < 1 ? 1 : interval_) {
+    file = std::fopen(path.c_str(), "w");
+    if (!file || format != METRICS_CSV) return;
+
+    std::fprintf(file, "tick,ticks");
+    for (const char* name : phase_names)
+        std::fprintf(file, ",%s_ms", name);
+    for (EntityType type : species_list) {
+        const char* name = species_names[type];
+        std::fprintf(file, ",%s_births,%s_deaths,%s_meals,%s_moves,%s_population", name, name, name, name, name);
+    }
+    std::fprintf(file, "\n");
+}
+
+Metrics::~Metrics() {
+    if (file) std::fclose(file);
+}
+
+void Metrics::end_tick(int tick, size_t algae, size_t herbivores, size_t predators) {
+    if (++ticks < interval) return;
+    const size_t population[PREDATOR + 1] = {0, 0, algae, herbivores, predators};
+    if (file) write_row(tick, population);
+
+    ticks = 0;
+    for (int64_t &ns : phase_ns) ns = 0;
+    for (SpeciesCounters &c : counters) c = {};
+}
+
+void Metrics::write_row(int tick, const size_t population[]) {
+    if (format == METRICS_CSV) {
+        std::fprintf(file, "%d,%d", tick, ticks);
+        for (int64_t ns : phase_ns)
+            std::fprintf(file, ",%.3f", ns / 1e6);
+        for (EntityType type : species_list) {
+            const SpeciesCounters &c = counters[type];
+            std::fprintf(file, ",%llu,%llu,%llu,%llu,%zu", static_cast<unsigned long long>(c.births),
+                         static_cast<unsigned long long>(c.deaths), static_cast<unsigned long long>(c.meals),
+                         static_cast<unsigned long long>(c.moves), population[type]);
+        }
+    } else {
+        std::fprintf(file, "{\"tick\": %d, \"ticks\": %d, \"phase_ms\": {", tick, ticks);
+        for (int p = 0; p < PHASE_COUNT; ++p)
+            std::fprintf(file, "%s\"%s\": %.3f", p ? ", " : "", phase_names[p], phase_ns[p] / 1e6);
+        std::fprintf(file, "}");
+        for (EntityType type : species_list) {
+            const SpeciesCounters &c = counters[type];
+            std::fprintf(file, ", \"%s\": {\"births\": %llu, \"deaths\": %llu, \"meals\": %llu, \"moves\": %llu, \"population\": %zu}",
+                         species_names[type], static_cast<unsigned long long>(c.births),
+                         static_cast<unsigned long long>(c.deaths), static_cast<unsigned long long>(c.meals),
+                         static_cast<unsigned long long>(c.moves), population[type]);
+        }
+        std::fprintf(file, "}");
+    }
+    // Строка целиком на диске: файл можно читать, пока идёт прогон.
+    std::fprintf(file, "\n");
+    std::fflush(file);
+}
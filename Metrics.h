@@ -0,0 +1,75 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "Entity.h"
+
+// Фазы тика и кадра. Первые четыре меряет Simulation::update, слепок и
+// отрисовку — интерфейс.
+enum Phase { PHASE_PROPOSE, PHASE_RESOLVE, PHASE_REMOVE, PHASE_SPAWN, PHASE_SNAPSHOT, PHASE_RENDER, PHASE_COUNT };
+
+// События одного вида: для водорослей рождение — посадка куста, смерть —
+// куст, объеденный до корня; едят и плавают только рыбы.
+struct SpeciesCounters {
+    uint64_t births = 0, deaths = 0, meals = 0, moves = 0;
+};
+
+enum MetricsFormat { METRICS_CSV, METRICS_NDJSON };
+
+// По расширению: .csv — CSV, всё остальное — NDJSON.
+inline MetricsFormat metrics_format_for(const std::string &path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0 ? METRICS_CSV : METRICS_NDJSON;
+}
+
+// Счётчики и времена фаз, накопленные за interval тиков, одной строкой
+// CSV или объектом NDJSON. Не потокобезопасен: пишет в него только
+// поток, который вызывает Simulation::update.
+class Metrics {
+public:
+    Metrics(const std::string &path, MetricsFormat format_, int interval_ = 10);
+    ~Metrics();
+
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    bool is_open() const { return file != nullptr; }
+
+    void add(Phase phase, int64_t nanoseconds) { phase_ns[phase] += nanoseconds; }
+    SpeciesCounters &species(EntityType type) { return counters[type]; }
+    // Конец тика: численность видов на этот момент; раз в interval тиков
+    // пишет строку и обнуляет накопленное.
+    void end_tick(int tick, size_t algae, size_t herbivores, size_t predators);
+
+private:
+    std::FILE* file = nullptr;
+    MetricsFormat format;
+    int interval;
+    int ticks = 0;
+    int64_t phase_ns[PHASE_COUNT] = {};
+    SpeciesCounters counters[PREDATOR + 1];
+
+    void write_row(int tick, const size_t population[]);
+};
+
+// Меряет время своей области в фазу phase; с metrics == nullptr не
+// читает часы вовсе.
+class PhaseTimer {
+public:
+    PhaseTimer(Metrics* metrics_, Phase phase_) : metrics(metrics_), phase(phase_) {
+        if (metrics) start = std::chrono::steady_clock::now();
+    }
+    ~PhaseTimer() {
+        if (metrics)
+            metrics->add(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start).count());
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    Metrics* metrics;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
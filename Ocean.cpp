@@ -1,503 +1,287 @@
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
-#include <vector>
+#include <ftxui/screen/terminal.hpp>
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <memory>
+#include <string>
 #include <thread>
 #include <atomic>
 #include <chrono>
-#include <algorithm>
-#include <random>
+#include "Simulation.h"
+#include "GlyphRenderer.h"
+#include "Replay.h"
+#include "TickScheduler.h"
+#include "TripleBuffer.h"
 
 using namespace ftxui;
 
-constexpr int width = 240;
-constexpr int height = 40;
-
-enum EntityType { EMPTY, SAND, ALGAE, HERBIVORE, PREDATOR };
-
-class Entity {
-public:
-    int x, y;
-    EntityType type;
-    bool to_delete = false;
-    virtual ~Entity() {}
-    virtual void update(const std::vector<std::vector<Entity*>> &grid,
-                        std::vector<std::vector<Entity*>> &new_grid) = 0;
-    virtual Element draw() const = 0;
-};
-
-class Sand : public Entity {
-public:
-    Sand(int x_, int y_) {
-        x = x_;
-        y = y_;
-        type = SAND;
-    }
-
-    void update(const std::vector<std::vector<Entity*>> & /*grid*/,
-                std::vector<std::vector<Entity*>> &new_grid) override {
-        new_grid[y][x] = this;
-    }
-
-    Element draw() const override {
-        return text("█") | color(Color::YellowLight) | bgcolor(Color::NavyBlue);
-    }
-};
-
-class Algae : public Entity {
-public:
-    int growth_stage = 0;
-    int max_height;
-    int origin_y;
-
-    Algae(int x_, int y_) {
-        x = x_;
-        y = y_;
-        type = ALGAE;
-        origin_y = y_;
-        max_height = 10 + rand() % 10;
-    }
-
-    Algae(int x_, int y_, int origin_y_, int max_height_) {
-        x = x_;
-        y = y_;
-        type = ALGAE;
-        origin_y = origin_y_;
-        max_height = max_height_;
-        growth_stage = origin_y_ - y_;
-    }
-
-    void update(const std::vector<std::vector<Entity*>> &grid,
-                std::vector<std::vector<Entity*>> &new_grid) override {
-        new_grid[y][x] = this;
-
-        if (growth_stage < max_height && y > 0 &&
-            grid[y - 1][x] == nullptr && new_grid[y - 1][x] == nullptr) {
-            new_grid[y - 1][x] = new Algae(x, y - 1, origin_y, max_height);
-        }
-    }
-
-    Element draw() const override {
-        return text("█") | color(Color::Green3) | bgcolor(Color::NavyBlue);
-    }
-};
-
-
-class HerbivoreFish : public Entity {
-public:
-    int hunger = 15;
-    int target_x = -1, target_y = -1;
-    bool just_born = true;
-    bool just_created = false;
-
-    HerbivoreFish(int x_, int y_) {
-        x = x_;
-        y = y_;
-        type = HERBIVORE;
-        just_born = true;
-    }
-
-    bool find_nearest_algae(const std::vector<std::vector<Entity*>> &grid) {
-        int best_dist = width + height;
-        int found_x = -1, found_y = -1;
-        for (int yy = 0; yy < height; ++yy) {
-            for (int xx = 0; xx < width; ++xx) {
-                if (grid[yy][xx] && grid[yy][xx]->type == ALGAE && !grid[yy][xx]->to_delete) {
-                    int dist = abs(x - xx) + abs(y - yy);
-                    if (dist < best_dist) {
-                        best_dist = dist;
-                        found_x = xx;
-                        found_y = yy;
-                    }
-                }
-            }
-        }
-        if (found_x != -1) {
-            target_x = found_x;
-            target_y = found_y;
-            return true;
-        }
-        target_x = target_y = -1;
-        return false;
-    }
-
-    void update(const std::vector<std::vector<Entity*>> &grid,
-                std::vector<std::vector<Entity*>> &new_grid) override {
-        if (just_created) {
-            just_created = false;
-            new_grid[y][x] = this;
-            return;
-        }
-
-        if (to_delete) return;
-
-        static int dx[] = {0, 1, -1, 0};
-        static int dy[] = {1, 0, 0, -1};
-        int nx = x, ny = y;
-
-        bool has_target = false;
-        if (target_x != -1 && target_y != -1) {
-            Entity* t = grid[target_y][target_x];
-            if (t && !t->to_delete && t->type == ALGAE)
-                has_target = true;
-        }
-
-        if (hunger < 15 && !has_target) {
-            find_nearest_algae(grid);
-        }
-
-        bool moved = false;
-
-        if (target_x != -1 && target_y != -1) {
-            int dx_move = (target_x > x) - (target_x < x);
-            int dy_move = (target_y > y) - (target_y < y);
-
-            int tx = x + dx_move;
-            int ty = y;
-
-            if (tx >= 0 && tx < width && ty >= 0 && ty < height) {
-                Entity* e = grid[ty][tx];
-                if (e && e->type == PREDATOR) {
-                    to_delete = true;
-                    return;
-                }
-                if (e && e->type == ALGAE) {
-                    e->to_delete = true;
-                    hunger = std::min(hunger + 2, 15);
-                    target_x = target_y = -1;
-                    nx = tx; ny = ty;
-                    moved = true;
-                } else if (!e && new_grid[ty][tx] == nullptr) {
-                    nx = tx; ny = ty;
-                    moved = true;
-                }
-            }
-
-            if (!moved) {
-                tx = x;
-                ty = y + dy_move;
-
-                if (tx >= 0 && tx < width && ty >= 0 && ty < height) {
-                    Entity* e = grid[ty][tx];
-                    if (e && e->type == PREDATOR) {
-                        to_delete = true;
-                        return;
-                    }
-                    if (e && e->type == ALGAE) {
-                        e->to_delete = true;
-                        hunger = std::min(hunger + 2, 15);
-                        target_x = target_y = -1;
-                        nx = tx; ny = ty;
-                        moved = true;
-                    } else if (!e && new_grid[ty][tx] == nullptr) {
-                        nx = tx; ny = ty;
-                        moved = true;
-                    }
-                }
-            }
-
-            if (!moved) {
-                target_x = target_y = -1;
-            }
-        }
-
-        if (!moved) {
-            hunger--;
-            int dir = rand() % 4;
-            int cx = x + dx[dir], cy = y + dy[dir];
-            if (cx >= 0 && cx < width && cy >= 0 && cy < height) {
-                Entity* occupant = grid[cy][cx];
-                if ((occupant == nullptr || occupant->type != PREDATOR) && new_grid[cy][cx] == nullptr) {
-                    nx = cx;
-                    ny = cy;
-                }
-            }
-        }
-
-        if (hunger <= 0) {
-            to_delete = true;
-            return;
-        }
-
-        new_grid[ny][nx] = this;
-        x = nx; y = ny;
-        just_born = false;
-    }
-
-
-
-    Element draw() const override {
-        return text("■") | color(Color::Orange1) | bgcolor(Color::NavyBlue);
-    }
-};
-
+constexpr const char* checkpoint_path = "ocean.ckpt";
+constexpr double frame_rate = 30;
+// Скорости в тиках в секунду; 0 — сколько успеем.
+constexpr double speeds[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 0};
+constexpr int speed_count = sizeof(speeds) / sizeof(speeds[0]);
 
-class PredatorFish : public Entity {
-public:
-    int hunger = 25;
-    bool chasing = false;
-    int target_x = -1, target_y = -1;
-    int wander_timer = 0;
-    bool just_born = true;
-    bool just_created = false;
+static std::string speed_name(double speed) {
+    return speed == 0 ? "max" : std::to_string(static_cast<int>(speed)) + "/s";
+}
 
-    PredatorFish(int x_, int y_) {
-        x = x_;
-        y = y_;
-        type = PREDATOR;
-        just_born = true;
+// Просмотр записанного повтора: пробел — пауза, + и - — скорость,
+// , и . — шаг на тик, [ и ] — на 100 тиков, Home/End — в начало и конец,
+// стрелки — окно.
+static int play(const char* path) {
+    ReplayReader replay(path);
+    if (!replay.is_open()) {
+        std::fprintf(stderr, "cannot open replay %s\n", path);
+        return 1;
     }
+    int width = replay.width();
+    int height = replay.height();
+
+    // Последняя строка терминала — под номер тика.
+    Dimensions term = Terminal::Size();
+    int view_width = std::min(width, term.dimx);
+    int view_height = std::max(std::min(height, term.dimy - 1), 1);
+    int view_left = 0, view_top = 0;
+    bool playing = true;
+    // Повтор не бывает быстрее последней конечной скорости.
+    int speed = 3;
+    TickScheduler scheduler(speeds[speed], frame_rate);
+    Grid<uint8_t> view(view_width, view_height, EMPTY);
 
-    void update(const std::vector<std::vector<Entity*>> &grid,
-                std::vector<std::vector<Entity*>> &new_grid) override {
-        if (just_created) {
-            just_created = false;
-            new_grid[y][x] = this;
-            return;
-        }
-
-        if (to_delete) return;
-
-        static int dx[] = {0, 1, -1, 0};
-        static int dy[] = {1, 0, 0, -1};
-
-        int nx = x, ny = y;
-        bool ate = false;
-
-        if (wander_timer > 0) {
-            wander_timer--;
-            hunger--;
-            int dir = rand() % 4;
-            int cx = x + dx[dir], cy = y + dy[dir];
-            if (cx >= 0 && cx < width && cy >= 0 && cy < height &&
-                grid[cy][cx] == nullptr && new_grid[cy][cx] == nullptr) {
-                nx = cx; ny = cy;
-            }
-            if (hunger <= 0) {
-                to_delete = true;
-                return;
-            }
-            new_grid[ny][nx] = this;
-            x = nx; y = ny;
-            just_born = false;
-            return;
-        }
-
-        if (chasing) {
-            Entity* target = nullptr;
-            if (target_x >= 0 && target_y >= 0 && target_x < width && target_y < height)
-                target = grid[target_y][target_x];
-            if (!target || target->to_delete || target->type != HERBIVORE) {
-                chasing = false;
-                target_x = target_y = -1;
-            }
-        }
+    auto screen = ScreenInteractive::TerminalOutput();
 
-        if (!chasing) {
-            int best_dist = width + height;
-            for (int yy = 0; yy < height; ++yy) {
-                for (int xx = 0; xx < width; ++xx) {
-                    if (grid[yy][xx] && grid[yy][xx]->type == HERBIVORE && !grid[yy][xx]->to_delete) {
-                        int dist = abs(x - xx) + abs(y - yy);
-                        if (dist < best_dist) {
-                            best_dist = dist;
-                            target_x = xx;
-                            target_y = yy;
-                        }
-                    }
-                }
-            }
-            chasing = (target_x != -1);
+    // Повтор читается только в потоке интерфейса; таймер лишь будит его
+    // раз в кадр, а сколько тиков пройти, решает scheduler.
+    auto player = Renderer([&] {
+        const Grid<uint8_t> &world = replay.cells();
+        for (int y = 0; y < view_height; ++y) {
+            auto src = world.row(view_top + y).subspan(view_left, view_width);
+            std::copy(src.begin(), src.end(), view.row(y).begin());
         }
+        char status[96];
+        std::snprintf(status, sizeof(status), "tick %d / %d  %s%s", replay.tick(), replay.last_tick(),
+                      speed_name(speeds[speed]).c_str(), playing ? "" : "  [pause]");
+        return vbox({grid_view(view), text(status)});
+    });
 
-        if (chasing) {
-            int dx_move = (target_x > x) - (target_x < x);
-            int dy_move = (target_y > y) - (target_y < y);
-
-            int tx = x + dx_move;
-            int ty = y;
-
-            if (tx >= 0 && tx < width && ty >= 0 && ty < height) {
-                Entity* e = grid[ty][tx];
-                if (e && e->type == HERBIVORE) {
-                    e->to_delete = true;
-                    hunger = 25;
-                    chasing = false;
-                    target_x = target_y = -1;
-                    wander_timer = 5 + rand() % 5;
-                    nx = tx; ny = ty;
-                    ate = true;
-                } else if (!e && new_grid[ty][tx] == nullptr) {
-                    nx = tx; ny = ty;
-                }
-            }
-
-            if (!ate) {
-                ty = y + dy_move;
-                tx = x;
-                if (tx >= 0 && tx < width && ty >= 0 && ty < height) {
-                    Entity* e = grid[ty][tx];
-                    if (e && e->type == HERBIVORE) {
-                        e->to_delete = true;
-                        hunger = 25;
-                        chasing = false;
-                        target_x = target_y = -1;
-                        wander_timer = 5 + rand() % 5;
-                        nx = tx; ny = ty;
-                        ate = true;
-                    } else if (!e && new_grid[ty][tx] == nullptr) {
-                        nx = tx; ny = ty;
-                    }
-                }
-            }
+    auto scroll = [](int &pos, int delta, int limit) {
+        pos = std::clamp(pos + delta, 0, std::max(limit, 0));
+    };
+
+    auto main_loop = CatchEvent(player, [&](Event event) {
+        if (event == Event::Character('q')) screen.Exit();
+        if (event == Event::Custom && scheduler.frame_due()) {
+            int ticks = 0;
+            while (scheduler.tick_due()) ++ticks;
+            if (ticks) replay.seek(replay.tick() + ticks);
+            if (replay.tick() == replay.last_tick()) playing = false;
         }
+        if (event == Event::Character(' ')) playing = !playing;
+        if (event == Event::Character('+')) speed = std::min(speed + 1, speed_count - 2);
+        if (event == Event::Character('-')) speed = std::max(speed - 1, 0);
+        scheduler.set_tick_rate(speeds[speed]);
+        scheduler.set_paused(!playing);
+        if (event == Event::Character(',')) replay.seek(replay.tick() - 1);
+        if (event == Event::Character('.')) replay.seek(replay.tick() + 1);
+        if (event == Event::Character('[')) replay.seek(replay.tick() - 100);
+        if (event == Event::Character(']')) replay.seek(replay.tick() + 100);
+        if (event == Event::Home) replay.seek(replay.first_tick());
+        if (event == Event::End) replay.seek(replay.last_tick());
+        if (event == Event::ArrowLeft) scroll(view_left, -8, width - view_width);
+        if (event == Event::ArrowRight) scroll(view_left, 8, width - view_width);
+        if (event == Event::ArrowUp) scroll(view_top, -4, height - view_height);
+        if (event == Event::ArrowDown) scroll(view_top, 4, height - view_height);
+        return true;
+    });
 
-        if (!ate) hunger--;
-        if (hunger <= 0) {
-            to_delete = true;
-            return;
+    std::atomic<bool> running = true;
+    std::thread timer([&]() {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(1 / frame_rate));
+            screen.PostEvent(Event::Custom);
         }
+    });
 
-        new_grid[ny][nx] = this;
-        x = nx; y = ny;
-        just_born = false;
-    }
-
-    Element draw() const override {
-        return text("■") | color(Color::Red3) | bgcolor(Color::NavyBlue);
-    }
-};
-
-
-std::vector<std::vector<Entity*>> grid(height, std::vector<Entity*>(width, nullptr));
+    screen.Loop(main_loop);
 
-Element render_grid() {
-    Elements rows;
-    for (int y = 0; y < height; ++y) {
-        Elements row;
-        for (int x = 0; x < width; ++x) {
-            if (grid[y][x])
-                row.push_back(grid[y][x]->draw());
-            else
-                row.push_back(text(" ") | bgcolor(Color::NavyBlue));
-        }
-        rows.push_back(hbox(std::move(row)));
-    }
-    return vbox(std::move(rows)) | bgcolor(Color::NavyBlue);
+    running = false;
+    timer.join();
+    return 0;
 }
 
-void initialize_sand() {
-    for (int y = height - 3; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (!grid[y][x])
-                grid[y][x] = new Sand(x, y);
-        }
+int main(int argc, char** argv) {
+    // Ocean [ширина высота] — новый мир; --config файл — сценарий (размер
+    // из аргументов важнее); Ocean --load файл — продолжить с контрольной
+    // точки (из --config берутся только layout и metrics_interval); --record файл — заодно писать повтор;
+    // --metrics файл — писать метрики фаз и видов (.csv или NDJSON),
+    // --metrics-interval N — строкой на N тиков (иначе из сценария);
+    // Ocean --replay файл — смотреть записанный повтор. На экране окно
+    // размером не больше терминала, стрелки сдвигают его по миру,
+    // + и - меняют скорость, 0 — сколько успеем, пробел — пауза,
+    // s сохраняет контрольную точку.
+    const char* load_path = nullptr;
+    const char* record_path = nullptr;
+    const char* metrics_path = nullptr;
+    const char* config_path = nullptr;
+    const char* interval_arg = nullptr;
+    long long size[2] = {0, 0};
+    int sizes = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && std::strcmp(argv[i], "--replay") == 0) return play(argv[i + 1]);
+        if (i + 1 < argc && std::strcmp(argv[i], "--load") == 0) load_path = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--record") == 0) record_path = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--metrics") == 0) metrics_path = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--metrics-interval") == 0) interval_arg = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--config") == 0) config_path = argv[++i];
+        else if (sizes < 2) size[sizes++] = std::strtoll(argv[i], nullptr, 10);
     }
-}
 
-void cleanup_grid() {
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            delete grid[y][x];
-            grid[y][x] = nullptr;
-        }
+    int threads = std::thread::hardware_concurrency();
+    Scenario scenario;
+    std::string error;
+    if (config_path && !load_scenario(config_path, scenario, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
     }
-}
-
-int tick_count = 0;
-
-void update_simulation() {
-    tick_count++;
-    std::vector<std::vector<Entity*>> new_grid(height, std::vector<Entity*>(width, nullptr));
-
-    // Появление
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (grid[y][x] && !grid[y][x]->to_delete) {
-                grid[y][x]->update(grid, new_grid);
-            }
+    std::unique_ptr<Simulation> sim;
+    if (load_path) {
+        sim = Simulation::load(load_path, threads, scenario.layout);
+        if (!sim) {
+            std::fprintf(stderr, "cannot load checkpoint %s\n", load_path);
+            return 1;
         }
-    }
-
-    // Удаление объектов
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (grid[y][x] && grid[y][x]->to_delete) {
-                delete grid[y][x];
-                grid[y][x] = nullptr;
+    } else {
+        if (sizes == 2) {
+            if (!world_valid(size[0], size[1], scenario.params, error)) {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
             }
+            scenario.width = static_cast<int>(size[0]);
+            scenario.height = static_cast<int>(size[1]);
         }
+        uint64_t seed = scenario.seed ? scenario.seed : static_cast<uint64_t>(time(NULL));
+        sim = std::make_unique<Simulation>(scenario.width, scenario.height, seed, threads, scenario.params,
+                                           scenario.layout);
     }
 
-    grid = std::move(new_grid);
-
-    // Появление водорослей
-    if (tick_count < 100 && rand() % 100 < 55) {
-        int x = rand() % width;
-        int y = height - 4;
-
-        bool nearby_algae = false;
-        int min_dist = 1 + rand() % 3;  // расстояние 1–3 клетки
-
-        for (int dx = -min_dist; dx <= min_dist; ++dx) {
-            int cx = x + dx;
-            if (cx >= 0 && cx < width && grid[y][cx] && grid[y][cx]->type == ALGAE) {
-                nearby_algae = true;
-                break;
-            }
-        }
-
-        if (!nearby_algae && !grid[y][x] && grid[y + 1][x] && grid[y + 1][x]->type == SAND) {
-            grid[y][x] = new Algae(x, y);
+    std::unique_ptr<ReplayRecorder> recorder;
+    if (record_path) {
+        recorder = std::make_unique<ReplayRecorder>(*sim, record_path);
+        if (!recorder->is_open()) {
+            std::fprintf(stderr, "cannot write replay %s\n", record_path);
+            return 1;
         }
+        recorder->record();
     }
 
-    // Появление травоядных
-    if (tick_count < 150 && rand() % 100 < 40) {
-        int x = rand() % width;
-        int y = rand() % (height - 4);
-        if (!grid[y][x]) {
-            grid[y][x] = new HerbivoreFish(x, y);
+    if (interval_arg) {
+        char* end;
+        long long value = std::strtoll(interval_arg, &end, 10);
+        if (*end || value < 1 || value > INT32_MAX) {
+            std::fprintf(stderr, "bad --metrics-interval %s\n", interval_arg);
+            return 1;
         }
+        scenario.metrics_interval = static_cast<int>(value);
     }
 
-    // Появление хищников
-    if (tick_count < 150 && rand() % 100 < 10) {
-        int x = rand() % width;
-        int y = rand() % (height - 4);
-        if (!grid[y][x]) {
-            grid[y][x] = new PredatorFish(x, y);
+    std::unique_ptr<Metrics> metrics;
+    if (metrics_path) {
+        metrics = std::make_unique<Metrics>(metrics_path, metrics_format_for(metrics_path),
+                                            scenario.metrics_interval);
+        if (!metrics->is_open()) {
+            std::fprintf(stderr, "cannot write metrics %s\n", metrics_path);
+            return 1;
         }
+        sim->set_metrics(metrics.get());
     }
-}
-
 
-int main() {
-    srand(time(NULL));
-    initialize_sand();
+    int width = sim->get_grid().width();
+    int height = sim->get_grid().height();
+
+    Dimensions term = Terminal::Size();
+    int view_width = std::min(width, term.dimx);
+    // Последняя строка терминала — под тик и скорость.
+    int view_height = std::max(std::min(height, term.dimy - 1), 1);
+    std::atomic<int> view_left = 0, view_top = 0;
+    std::atomic<bool> save_requested = false;
+    std::atomic<bool> save_failed = false;
+    std::atomic<int> speed = 3;
+    std::atomic<bool> paused = false;
+    // Пока кадр не нарисован, новых событий не шлём: если интерфейс не
+    // успевает, он рисует сразу последний слепок, пропуская промежуточные.
+    std::atomic<bool> frame_pending = false;
+    // Metrics пишет только поток обновления: время отрисовки интерфейс
+    // копит здесь, а поток обновления забирает его в PHASE_RENDER.
+    std::atomic<int64_t> render_ns = 0;
+
+    // Симуляция принадлежит потоку обновления; отрисовка видит только
+    // опубликованные слепки и никогда не трогает sim.
+    TripleBuffer<Snapshot> frames(Snapshot(view_width, view_height));
+    auto publish = [&] {
+        Snapshot &next = frames.write_buffer();
+        next.left = view_left;
+        next.top = view_top;
+        PhaseTimer timer(metrics.get(), PHASE_SNAPSHOT);
+        sim->snapshot(next);
+        frames.publish();
+    };
+    publish();
 
     auto screen = ScreenInteractive::TerminalOutput();
 
     std::atomic<bool> running = true;
 
-    auto simulation = Renderer([] {
-        return render_grid();
+    auto simulation = Renderer([&] {
+        frame_pending = false;
+        const Snapshot &frame = frames.read();
+        std::string status = "tick " + std::to_string(frame.tick) + "  " + speed_name(speeds[speed]) +
+                             (paused ? "  [pause]" : "") +
+                             (save_failed ? std::string("  [cannot save ") + checkpoint_path + "]" : "");
+        return vbox({grid_view(frame.cells, metrics ? &render_ns : nullptr), text(status)});
     });
 
+    auto scroll = [](std::atomic<int> &pos, int delta, int limit) {
+        pos = std::clamp(pos + delta, 0, std::max(limit, 0));
+    };
+
     auto main_loop = CatchEvent(simulation, [&](Event event) {
         if (event == Event::Character('q')) {
             running = false;
             screen.Exit();
         }
+        if (event == Event::Character('s')) save_requested = true;
+        if (event == Event::Character(' ')) paused = !paused;
+        if (event == Event::Character('+')) speed = std::min(speed + 1, speed_count - 1);
+        if (event == Event::Character('-')) speed = std::max(speed - 1, 0);
+        if (event == Event::Character('0')) speed = speed_count - 1;
+        if (event == Event::ArrowLeft) scroll(view_left, -8, width - view_width);
+        if (event == Event::ArrowRight) scroll(view_left, 8, width - view_width);
+        if (event == Event::ArrowUp) scroll(view_top, -4, height - view_height);
+        if (event == Event::ArrowDown) scroll(view_top, 4, height - view_height);
         return true;
     });
 
     std::thread update_thread([&]() {
+        TickScheduler scheduler(speeds[speed], frame_rate);
         while (running) {
-            update_simulation();
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
-            screen.PostEvent(Event::Custom);
+            scheduler.set_tick_rate(speeds[speed]);
+            scheduler.set_paused(paused);
+            if (metrics) metrics->add(PHASE_RENDER, render_ns.exchange(0));
+            while (scheduler.tick_due()) {
+                sim->update();
+                if (recorder) recorder->record();
+            }
+            // Сохранение идёт в потоке обновления, между тиками.
+            if (save_requested.exchange(false)) save_failed = !sim->save(checkpoint_path);
+            if (scheduler.frame_due()) {
+                publish();
+                if (!frame_pending.exchange(true)) screen.PostEvent(Event::Custom);
+            }
+            scheduler.wait();
         }
     });
 
@@ -506,7 +290,5 @@ int main() {
     running = false;
     update_thread.join();
 
-    cleanup_grid();
-
     return 0;
 }
@@ -0,0 +1,141 @@
+#include "Params.h"
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+struct Field {
+    const char* name;
+    int Params::*member;
+    int min;
+};
+
+const Field fields[] = {
+    {"herbivore_hunger", &Params::herbivore_hunger, 1},
+    {"predator_hunger", &Params::predator_hunger, 1},
+    {"herbivore_meal", &Params::herbivore_meal, 0},
+    {"predator_rest", &Params::predator_rest, 0},
+    {"predator_rest_range", &Params::predator_rest_range, 1},
+    {"algae_height", &Params::algae_height, 1},
+    {"algae_height_range", &Params::algae_height_range, 1},
+    {"algae_spawn", &Params::algae_spawn, 0},
+    {"herbivore_spawn", &Params::herbivore_spawn, 0},
+    {"predator_spawn", &Params::predator_spawn, 0},
+    {"algae_spawn_until", &Params::algae_spawn_until, 0},
+    {"fish_spawn_until", &Params::fish_spawn_until, 0},
+    {"initial_algae", &Params::initial_algae, 0},
+    {"initial_herbivores", &Params::initial_herbivores, 0},
+    {"initial_predators", &Params::initial_predators, 0},
+    {"seabed_depth", &Params::seabed_depth, 1},
+};
+
+std::string trim(const std::string &s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return {};
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+bool parse_number(const std::string &text, long long min, long long max, long long &value) {
+    char* end;
+    errno = 0;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0' && errno == 0 && value >= min && value <= max;
+}
+
+}
+
+bool parse_layout(const std::string &name, GridLayout &out) {
+    if (name == "rows") out = LAYOUT_ROWS;
+    else if (name == "morton") out = LAYOUT_MORTON;
+    else return false;
+    return true;
+}
+
+const char* layout_name(GridLayout layout) {
+    return layout == LAYOUT_MORTON ? "morton" : "rows";
+}
+
+bool params_valid(const Params &params) {
+    for (const Field &f : fields)
+        if (params.*f.member < f.min) return false;
+    return true;
+}
+
+bool world_valid(long long width, long long height, const Params &params, std::string &error) {
+    if (width < 1 || width > max_side || height < 1 || height > max_side) {
+        error = "width and height must be between 1 and " + std::to_string(max_side);
+        return false;
+    }
+    if (width * height > UINT32_MAX) {
+        error = "width * height must be less than 2^32";
+        return false;
+    }
+    // На дне нужна вода над песком; рыбы появляются в верхних height - 5 строках.
+    if (height <= params.seabed_depth || height <= 5) {
+        error = "height must be greater than 5 and than seabed_depth";
+        return false;
+    }
+    return true;
+}
+
+bool load_scenario(const std::string &path, Scenario &out, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+
+    Scenario result = out;
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        auto fail = [&](const std::string &why) {
+            error = path + ":" + std::to_string(number) + ": " + why;
+            return false;
+        };
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) return fail("expected name = value");
+        std::string name = trim(line.substr(0, eq));
+        std::string text = trim(line.substr(eq + 1));
+        long long value;
+
+        if (name == "width" || name == "height") {
+            if (!parse_number(text, 1, max_side, value)) return fail("bad " + name + " '" + text + "'");
+            (name == "width" ? result.width : result.height) = static_cast<int>(value);
+            continue;
+        }
+        if (name == "seed") {
+            if (!parse_number(text, 0, INT64_MAX, value)) return fail("bad seed '" + text + "'");
+            result.seed = static_cast<uint64_t>(value);
+            continue;
+        }
+        if (name == "metrics_interval") {
+            if (!parse_number(text, 1, INT32_MAX, value)) return fail("bad metrics_interval '" + text + "'");
+            result.metrics_interval = static_cast<int>(value);
+            continue;
+        }
+        if (name == "layout") {
+            if (!parse_layout(text, result.layout)) return fail("bad layout '" + text + "', expected rows or morton");
+            continue;
+        }
+
+        const Field* field = nullptr;
+        for (const Field &f : fields)
+            if (name == f.name) field = &f;
+        if (!field) return fail("unknown parameter '" + name + "'");
+        if (!parse_number(text, field->min, INT32_MAX, value))
+            return fail("bad " + name + " '" + text + "', expected an integer >= " + std::to_string(field->min));
+        result.params.*field->member = static_cast<int>(value);
+    }
+
+    if (!world_valid(result.width, result.height, result.params, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    out = result;
+    return true;
+}
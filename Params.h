@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "SparseGrid.h"
+
+// Постоянные поведения. Значения по умолчанию — исходная игра.
+struct Params {
+    // Запас сытости: новорождённая рыба начинает с него, травоядная ищет
+    // еду, когда голоднее, хищник восполняет его целиком после охоты.
+    int herbivore_hunger = 15;
+    int predator_hunger = 25;
+    // Сколько сытости даёт травоядной одна съеденная клетка водорослей.
+    int herbivore_meal = 2;
+    // После охоты хищник бродит predator_rest + [0, predator_rest_range) тиков.
+    int predator_rest = 5;
+    int predator_rest_range = 5;
+    // Предельная высота куста: algae_height + [0, algae_height_range).
+    int algae_height = 10;
+    int algae_height_range = 10;
+
+    // Вероятность появления в процентах за тик, пока tick меньше границы.
+    int algae_spawn = 55;
+    int herbivore_spawn = 40;
+    int predator_spawn = 10;
+    int algae_spawn_until = 100;
+    int fish_spawn_until = 150;
+
+    // Начальное заселение на каждые 100 столбцов и толщина дна.
+    int initial_algae = 20;
+    int initial_herbivores = 10;
+    int initial_predators = 5;
+    int seabed_depth = 3;
+
+    bool operator==(const Params &) const = default;
+};
+
+// Откуда горячий цикл берёт параметры. RuntimeParams читает их из
+// TickContext; FixedParams<набор> — константа времени компиляции, и в
+// собранном для неё тике пороги и диапазоны сворачиваются в литералы.
+struct RuntimeParams {
+    template <class Context>
+    static const Params &of(const Context &ctx) { return ctx.params; }
+};
+
+template <Params values>
+struct FixedParams {
+    template <class Context>
+    static constexpr const Params &of(const Context &) { return values; }
+};
+
+using DefaultParams = FixedParams<Params{}>;
+
+// Сценарий запуска: размер мира, seed (0 — от текущего времени),
+// параметры поведения и порядок клеток в сетке.
+struct Scenario {
+    int width = 240, height = 40;
+    uint64_t seed = 0;
+    Params params;
+    GridLayout layout = LAYOUT_ROWS;
+    // Раз во столько тиков пишется строка метрик.
+    int metrics_interval = 10;
+};
+
+// "rows" или "morton"; при неизвестном имени false, out не меняется.
+bool parse_layout(const std::string &name, GridLayout &out);
+const char* layout_name(GridLayout layout);
+
+// Сторона мира не больше max_side.
+constexpr int max_side = 1 << 20;
+
+// Мир width × height годится для Simulation: стороны от 1 до max_side,
+// клеток меньше 2^32 (номер клетки — 32-битный key намерения), а height
+// больше 5 и больше seabed_depth. Иначе false, а в error — причина.
+bool world_valid(long long width, long long height, const Params &params, std::string &error);
+
+// Все поля не меньше своих минимумов (делители и запасы сытости — не меньше 1).
+bool params_valid(const Params &params);
+
+// Читает сценарий из текстового файла строк "имя = значение"; # до конца
+// строки — комментарий, неназванные поля остаются как в out. При ошибке
+// false, out не меняется, а в error — файл, строка и причина.
+bool load_scenario(const std::string &path, Scenario &out, std::string &error);
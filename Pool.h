@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Пул объектов одного типа: память выделяется блоками по block_size слотов,
+// освобождённые слоты попадают в список свободных и переиспользуются.
+// Адреса объектов стабильны, пока объект жив. Живые объекты дополнительно
+// собраны в плотный список objects() без дыр.
+template <class T>
+class Pool {
+public:
+    explicit Pool(size_t block_size_ = 256) : block_size(block_size_) {}
+    ~Pool() { reset(); }
+
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    template <class... Args>
+    T* create(Args&&... args) {
+        if (!free_list) grow();
+        Slot* slot = free_list;
+        free_list = slot->next;
+        T* obj = new (slot->storage) T(std::forward<Args>(args)...);
+        slot->live = true;
+        slot->index = active.size();
+        active.push_back(obj);
+        peak_count = std::max(peak_count, active.size());
+        return obj;
+    }
+
+    // Место уничтоженного в objects() занимает последний объект.
+    void destroy(T* obj) {
+        Slot* slot = reinterpret_cast<Slot*>(obj);
+        T* last = active.back();
+        active[slot->index] = last;
+        reinterpret_cast<Slot*>(last)->index = slot->index;
+        active.pop_back();
+
+        obj->~T();
+        slot->live = false;
+        slot->next = free_list;
+        free_list = slot;
+    }
+
+    // Уничтожает все живые объекты; блоки остаются для повторного использования.
+    void reset() {
+        free_list = nullptr;
+        for (size_t b = blocks.size(); b-- > 0;) {
+            for (size_t i = block_size; i-- > 0;) {
+                Slot &slot = blocks[b][i];
+                if (slot.live) {
+                    std::launder(reinterpret_cast<T*>(slot.storage))->~T();
+                    slot.live = false;
+                }
+                slot.next = free_list;
+                free_list = &slot;
+            }
+        }
+        active.clear();
+    }
+
+    std::span<T* const> objects() const { return active; }
+    size_t live() const { return active.size(); }
+    size_t peak() const { return peak_count; }
+    size_t capacity() const { return blocks.size() * block_size; }
+
+private:
+    struct Slot {
+        union {
+            Slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+        bool live = false;
+        size_t index = 0;   // место в active
+    };
+
+    size_t block_size;
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    std::vector<T*> active;
+    Slot* free_list = nullptr;
+    size_t peak_count = 0;
+
+    // active вмещает все слоты, так что create выделяет память только здесь.
+    void grow() {
+        blocks.emplace_back(new Slot[block_size]);
+        active.reserve(capacity());
+        Slot* block = blocks.back().get();
+        for (size_t i = block_size; i-- > 0;) {
+            block[i].next = free_list;
+            free_list = &block[i];
+        }
+    }
+};
@@ -1,60 +1,90 @@
 #include "PredatorFish.h"
 #include "HerbivoreFish.h"
-#include <cstdlib>
-#include <ftxui/dom/elements.hpp>
-using namespace ftxui;
+#include "SpatialIndex.h"
 
-PredatorFish::PredatorFish(int x_, int y_) {
+PredatorFish::PredatorFish(int x_, int y_, int hunger_) {
     x = x_;
     y = y_;
+    hunger = hunger_;
     type = PREDATOR;
+    just_born = true;
 }
 
-void PredatorFish::update(const std::vector<std::vector<Entity*>> &grid,
-                          std::vector<std::vector<Entity*>> &new_grid) {
-    if (to_delete) return;
-
-    static int dx[] = {0, 1, -1, 0};
-    static int dy[] = {1, 0, 0, -1};
-    int nx = x, ny = y;
-    bool moved = false;
-
-    for (int d = 0; d < 4 && !moved; ++d) {
-        int cx = x + dx[d], cy = y + dy[d];
-        if (cx >= 0 && cx < grid[0].size() && cy >= 0 && cy < grid.size()) {
-            Entity* e = grid[cy][cx];
-            if (e && e->type == HERBIVORE) {
-                e->to_delete = true;
-                hunger = std::min(hunger + 5, 20);
-                nx = cx; ny = cy;
-                moved = true;
-            }
-        }
+template <class P>
+Intent PredatorFish::propose(const TickContext &ctx) {
+    const EntityGrid &grid = ctx.grid;
+    if (just_created) {
+        just_created = false;
+        return stay();
     }
 
-    if (!moved) {
+    if (wander_timer > 0) {
+        wander_timer--;
         hunger--;
-        int d = rand() % 4;
-        int cx = x + dx[d], cy = y + dy[d];
-        if (cx >= 0 && cx < grid[0].size() && cy >= 0 && cy < grid.size()) {
-            Entity* e = grid[cy][cx];
-            if (!e && new_grid[cy][cx] == nullptr) {
-                nx = cx;
-                ny = cy;
-            }
+        if (hunger <= 0) return act(DIE, x, y);
+        int dir = ctx.random(*this, STREAM_WALK) % 4;
+        int cx = x + neighbour_dx[dir], cy = y + neighbour_dy[dir];
+        if (ctx.free(cx, cy))
+            return act(MOVE, cx, cy);
+        return stay();
+    }
+
+    if (chasing) {
+        // Цель погони — клетка, где добыча была в мире. Мёртвых к началу
+        // тика в мире не остаётся, так что травоядная там — живая добыча.
+        if (grid(target_x, target_y) != HERBIVORE) {
+            chasing = false;
+            target_x = target_y = -1;
         }
     }
 
-    if (hunger <= 0) {
-        to_delete = true;
-        return;
+    if (!chasing) {
+        Entity* prey = ctx.index.find_nearest(HERBIVORE, x, y, grid.width() + grid.height() - 1);
+        if (prey) {
+            target_x = prey->x;
+            target_y = prey->y;
+        }
+        chasing = (target_x != -1);
     }
 
-    new_grid[ny][nx] = this;
-    x = nx;
-    y = ny;
+    Intent intent = stay();
+    if (chasing) {
+        int dx_move = (target_x > x) - (target_x < x);
+        int dy_move = (target_y > y) - (target_y < y);
+
+        int steps[2][2] = {{x + dx_move, y}, {x, y + dy_move}};
+        for (auto& step : steps) {
+            int tx = step[0], ty = step[1];
+            EntityType cell = grid(tx, ty);
+            if (cell == HERBIVORE) return act(EAT, tx, ty);
+            if (cell == EMPTY) intent = act(MOVE, tx, ty);
+        }
+    }
+
+    hunger--;
+    if (hunger <= 0) return act(DIE, x, y);
+    return intent;
 }
 
-Element PredatorFish::draw() const {
-    return text("■") | color(Color::RedLight) | bgcolor(Color::NavyBlue);
+// Сытость после EAT засчитывается только при удачной охоте:
+// голод за этот тик списывается здесь, если добычу перехватили.
+template <class P>
+void PredatorFish::resolve(const Intent &intent, bool granted, const TickContext &ctx) {
+    const Params &params = P::of(ctx);
+    if (intent.action == EAT) {
+        if (granted) {
+            hunger = params.predator_hunger;
+            chasing = false;
+            target_x = target_y = -1;
+            wander_timer = params.predator_rest + ctx.random(*this, STREAM_WANDER) % params.predator_rest_range;
+        } else if (--hunger <= 0) {
+            to_delete = true;
+        }
+    }
+    just_born = false;
 }
+
+template Intent PredatorFish::propose<RuntimeParams>(const TickContext &);
+template Intent PredatorFish::propose<DefaultParams>(const TickContext &);
+template void PredatorFish::resolve<RuntimeParams>(const Intent &, bool, const TickContext &);
+template void PredatorFish::resolve<DefaultParams>(const Intent &, bool, const TickContext &);
@@ -3,10 +3,18 @@
 
 class PredatorFish : public Entity {
 public:
-    int hunger = 20;
+    static constexpr EntityType kind = PREDATOR;
 
-    PredatorFish(int x_, int y_);
-    void update(const std::vector<std::vector<Entity*>> &grid,
-                std::vector<std::vector<Entity*>> &new_grid) override;
-    ftxui::Element draw() const override;
+    int hunger;
+    bool chasing = false;
+    int target_x = -1, target_y = -1;
+    int wander_timer = 0;
+    bool just_born = true;
+    bool just_created = false;
+
+    PredatorFish(int x_, int y_, int hunger_);
+    template <class P>
+    Intent propose(const TickContext &ctx);
+    template <class P>
+    void resolve(const Intent &intent, bool granted, const TickContext &ctx);
 };
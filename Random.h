@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Потоки случайных чисел: у каждого места, где нужна случайность, свой.
+enum RandomStream : uint32_t {
+    STREAM_WALK,
+    STREAM_WANDER,
+    STREAM_INIT,
+    STREAM_SPAWN_ALGAE,
+    STREAM_SPAWN_HERBIVORE,
+    STREAM_SPAWN_PREDATOR,
+};
+
+// Счётчиковый генератор Philox4x32-10. Значение зависит только от
+// (seed, tick, id, stream, n), поэтому у генератора нет изменяемого
+// состояния и результат не зависит от порядка обхода и числа потоков.
+// id 0 зарезервирован за событиями мира (начальное заполнение, появление).
+class Rng {
+public:
+    explicit Rng(uint64_t seed_) : seed(seed_) {}
+
+    uint64_t get_seed() const { return seed; }
+
+    uint32_t operator()(uint32_t tick, uint32_t id, uint32_t stream, uint32_t n = 0) const {
+        uint32_t out[4];
+        block(tick, id, stream, n / 4, out);
+        return out[n % 4];
+    }
+
+    // Заполняет out[0..count) значениями с номерами first, first + 1, ...
+    void fill(uint32_t tick, uint32_t id, uint32_t stream,
+              uint32_t* out, size_t count, uint32_t first = 0) const {
+        size_t i = 0;
+        uint32_t buf[4];
+        while (i < count) {
+            uint32_t n = first + static_cast<uint32_t>(i);
+            block(tick, id, stream, n / 4, buf);
+            for (uint32_t k = n % 4; k < 4 && i < count; ++k)
+                out[i++] = buf[k];
+        }
+    }
+
+private:
+    uint64_t seed;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t &hi, uint32_t &lo) {
+        uint64_t p = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(p >> 32);
+        lo = static_cast<uint32_t>(p);
+    }
+
+    void block(uint32_t tick, uint32_t id, uint32_t stream, uint32_t counter, uint32_t out[4]) const {
+        uint32_t c0 = counter, c1 = id, c2 = tick, c3 = stream;
+        uint32_t k0 = static_cast<uint32_t>(seed), k1 = static_cast<uint32_t>(seed >> 32);
+        for (int round = 0; round < 10; ++round) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(0xD2511F53u, c0, hi0, lo0);
+            mulhilo(0xCD9E8D57u, c2, hi1, lo1);
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+    }
+};
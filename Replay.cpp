@@ -0,0 +1,265 @@
+#include "Replay.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace replay;
+
+namespace {
+
+// Не больше 10 байт на значение; место под них выделяет вызывающий.
+unsigned char* put_varint(unsigned char* out, uint64_t v) {
+    while (v >= 0x80) {
+        *out++ = static_cast<unsigned char>(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = static_cast<unsigned char>(v);
+    return out;
+}
+
+constexpr size_t max_varint = 10;
+
+bool get_varint(const unsigned char* &at, const unsigned char* end, uint64_t &v) {
+    v = 0;
+    for (int shift = 0; at < end && shift < 64; shift += 7) {
+        unsigned char b = *at++;
+        v |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t width, height;
+    int32_t interval;
+};
+
+struct Trailer {
+    uint64_t index_offset;
+    char magic[8];
+};
+
+}
+
+ReplayRecorder::ReplayRecorder(Simulation &sim_, const std::string &path, int interval_)
+    : sim(sim_), interval(std::max(interval_, 1)),
+      world(sim_.get_grid().width(), sim_.get_grid().height()) {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return;
+
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.width = world.cells.width();
+    header.height = world.cells.height();
+    header.interval = interval;
+    write(&header, sizeof(header));
+    sim.set_change_log(&changes);
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    finish();
+}
+
+void ReplayRecorder::write(const void* data, size_t size) {
+    if (std::fwrite(data, 1, size, file) != size) failed = true;
+    offset += size;
+}
+
+void ReplayRecorder::write_frame(FrameKind kind, int tick, size_t size) {
+    unsigned char header[1 + 2 * max_varint];
+    unsigned char* end = header;
+    *end++ = kind;
+    end = put_varint(end, static_cast<uint64_t>(tick));
+    end = put_varint(end, size);
+    if (kind == KEYFRAME) keys.push_back({tick, offset});
+    write(header, end - header);
+    write(payload.data(), size);
+}
+
+void ReplayRecorder::record() {
+    if (!file) return;
+    int tick = sim.get_tick();
+    int w = world.cells.width();
+
+    if (frames++ % interval == 0) {
+        sim.snapshot(world);
+        const uint8_t* cells = world.cells.data();
+        size_t n = static_cast<size_t>(w) * world.cells.height();
+        // Серия длины r занимает не больше 1 + r байт, то есть не больше 2 байт на клетку.
+        payload.resize(2 * n);
+        unsigned char* out = payload.data();
+        for (size_t i = 0; i < n;) {
+            size_t run = 1;
+            while (i + run < n && cells[i + run] == cells[i]) ++run;
+            out = put_varint(out, run);
+            *out++ = cells[i];
+            i += run;
+        }
+        write_frame(KEYFRAME, tick, out - payload.data());
+    } else {
+        payload.resize((changes.size() + 1) * (max_varint + 1));
+        unsigned char* out = put_varint(payload.data(), changes.size());
+        int64_t previous = 0;
+        for (const CellChange &c : changes) {
+            int64_t cell = static_cast<int64_t>(c.y) * w + c.x;
+            out = put_varint(out, zigzag(cell - previous));
+            *out++ = c.type;
+            previous = cell;
+        }
+        write_frame(DELTA, tick, out - payload.data());
+    }
+    changes.clear();
+}
+
+bool ReplayRecorder::finish() {
+    if (!file) return false;
+    sim.set_change_log(nullptr);
+
+    uint64_t index_offset = offset;
+    uint32_t count = static_cast<uint32_t>(keys.size());
+    write(&count, sizeof(count));
+    for (const KeyframeEntry &k : keys) {
+        int32_t tick = k.tick;
+        write(&tick, sizeof(tick));
+        write(&k.offset, sizeof(k.offset));
+    }
+    Trailer trailer{index_offset, {}};
+    std::memcpy(trailer.magic, index_magic, sizeof(index_magic));
+    write(&trailer, sizeof(trailer));
+
+    bool ok = std::fclose(file) == 0 && !failed;
+    file = nullptr;
+    return ok;
+}
+
+ReplayReader::ReplayReader(const std::string &path) : file(path) {
+    if (!file.data() || file.size() < sizeof(FileHeader)) return;
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+        header.width <= 0 || header.height <= 0)
+        return;
+
+    plane = Grid<uint8_t>(header.width, header.height, EMPTY);
+    frames_begin = sizeof(FileHeader);
+    if (!read_index()) rebuild_index();
+    if (keys.empty()) return;
+
+    // Последний тик — у последнего целого кадра после последнего ключевого.
+    Frame f;
+    for (size_t at = keys.back().offset; parse(at, f); at = f.next)
+        final_tick = f.tick;
+
+    ok = seek(first_tick());
+}
+
+bool ReplayReader::read_index() {
+    if (file.size() < frames_begin + sizeof(Trailer)) return false;
+    Trailer trailer;
+    std::memcpy(&trailer, file.data() + file.size() - sizeof(Trailer), sizeof(Trailer));
+    if (std::memcmp(trailer.magic, index_magic, sizeof(index_magic)) != 0) return false;
+
+    size_t at = trailer.index_offset;
+    uint32_t count;
+    if (at < frames_begin || at + sizeof(count) > file.size() - sizeof(Trailer)) return false;
+    std::memcpy(&count, file.data() + at, sizeof(count));
+    at += sizeof(count);
+    const size_t entry = sizeof(int32_t) + sizeof(uint64_t);
+    if (at + count * entry != file.size() - sizeof(Trailer)) return false;
+
+    keys.resize(count);
+    for (KeyframeEntry &k : keys) {
+        int32_t tick;
+        std::memcpy(&tick, file.data() + at, sizeof(tick));
+        std::memcpy(&k.offset, file.data() + at + sizeof(tick), sizeof(k.offset));
+        k.tick = tick;
+        at += entry;
+        if (k.offset < frames_begin || k.offset >= trailer.index_offset) return false;
+    }
+    frames_end = trailer.index_offset;
+    return true;
+}
+
+void ReplayReader::rebuild_index() {
+    keys.clear();
+    frames_end = file.size();
+    Frame f;
+    size_t at = frames_begin;
+    for (; parse(at, f); at = f.next)
+        if (f.kind == KEYFRAME) keys.push_back({f.tick, at});
+    frames_end = at;
+}
+
+bool ReplayReader::parse(size_t at, Frame &out) const {
+    if (at >= frames_end) return false;
+    const unsigned char* p = file.data() + at;
+    const unsigned char* end = file.data() + frames_end;
+    uint64_t tick, size;
+    unsigned char kind = *p++;
+    if (kind > DELTA || !get_varint(p, end, tick) || !get_varint(p, end, size) ||
+        size > static_cast<uint64_t>(end - p))
+        return false;
+    out.kind = static_cast<FrameKind>(kind);
+    out.tick = static_cast<int>(tick);
+    out.data = p;
+    out.size = size;
+    out.next = (p - file.data()) + size;
+    return true;
+}
+
+bool ReplayReader::apply(const Frame &frame) {
+    const unsigned char* p = frame.data;
+    const unsigned char* end = p + frame.size;
+    uint8_t* cells = plane.data();
+    uint64_t n = static_cast<uint64_t>(plane.width()) * plane.height();
+
+    if (frame.kind == KEYFRAME) {
+        uint64_t filled = 0;
+        while (filled < n) {
+            uint64_t run;
+            if (!get_varint(p, end, run) || p >= end || run > n - filled) return false;
+            std::memset(cells + filled, *p++, run);
+            filled += run;
+        }
+    } else {
+        uint64_t count, step;
+        if (!get_varint(p, end, count)) return false;
+        int64_t cell = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!get_varint(p, end, step) || p >= end) return false;
+            cell += unzigzag(step);
+            if (cell < 0 || static_cast<uint64_t>(cell) >= n) return false;
+            cells[cell] = *p++;
+        }
+    }
+    current_tick = frame.tick;
+    return true;
+}
+
+bool ReplayReader::seek(int tick) {
+    if (keys.empty()) return false;
+    tick = std::clamp(tick, first_tick(), last_tick());
+
+    auto key = std::upper_bound(keys.begin(), keys.end(), tick,
+                                [](int t, const KeyframeEntry &k) { return t < k.tick; }) - 1;
+    // Вперёд от текущего кадра, если ключевой кадр не ближе.
+    bool restart = current_tick < key->tick || current_tick > tick;
+    if (restart) cursor = key->offset;
+
+    Frame f;
+    while (restart || current_tick < tick) {
+        if (!parse(cursor, f) || !apply(f)) {
+            current_tick = -1;
+            return false;
+        }
+        cursor = f.next;
+        restart = false;
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Grid.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+
+class Simulation;
+
+// Файл повтора:
+//
+//     magic "OCEANRPL", version u32, width i32, height i32, interval i32
+//     кадры: kind u8, tick varint, длина varint, данные
+//         keyframe — весь мир построчно, RLE: (длина серии varint, тип u8)...
+//         delta    — число изменений varint, затем для каждого
+//                    zigzag(индекс клетки − предыдущий) varint, тип u8
+//     индекс: count u32, (tick i32, смещение кадра u64) для ключевых кадров
+//     хвост: смещение индекса u64, magic "OCEANIDX"
+//
+// Если запись оборвалась и хвоста нет, читатель восстанавливает индекс
+// проходом по кадрам.
+namespace replay {
+
+constexpr char magic[8] = {'O', 'C', 'E', 'A', 'N', 'R', 'P', 'L'};
+constexpr char index_magic[8] = {'O', 'C', 'E', 'A', 'N', 'I', 'D', 'X'};
+constexpr uint32_t version = 1;
+
+enum FrameKind : uint8_t { KEYFRAME, DELTA };
+
+struct KeyframeEntry {
+    int tick;
+    uint64_t offset;
+};
+
+}
+
+// Пишет повтор: record() после каждого Simulation::update(). Изменения
+// берутся из журнала изменений симуляции, так что дельта стоит
+// пропорционально числу событий тика; полный кадр пишется раз в interval
+// тиков.
+class ReplayRecorder {
+public:
+    ReplayRecorder(Simulation &sim_, const std::string &path, int interval_ = 100);
+    ~ReplayRecorder();
+
+    ReplayRecorder(const ReplayRecorder &) = delete;
+    ReplayRecorder &operator=(const ReplayRecorder &) = delete;
+
+    bool is_open() const { return file != nullptr; }
+    void record();
+    // Дописывает индекс и закрывает файл; вызывается и из деструктора.
+    bool finish();
+
+private:
+    Simulation &sim;
+    std::FILE* file = nullptr;
+    int interval;
+    int frames = 0;
+    uint64_t offset = 0;
+    bool failed = false;
+    std::vector<CellChange> changes;
+    std::vector<replay::KeyframeEntry> keys;
+    Snapshot world;
+    std::vector<unsigned char> payload;
+
+    void write_frame(replay::FrameKind kind, int tick, size_t size);
+    void write(const void* data, size_t size);
+};
+
+// Читает повтор через отображение в память и перематывает его: seek()
+// восстанавливает ближайший предыдущий ключевой кадр и докатывает дельты,
+// то есть стоит не больше интервала ключевых кадров.
+class ReplayReader {
+public:
+    explicit ReplayReader(const std::string &path);
+
+    bool is_open() const { return ok; }
+    int width() const { return plane.width(); }
+    int height() const { return plane.height(); }
+    int first_tick() const { return keys.empty() ? 0 : keys.front().tick; }
+    int last_tick() const { return final_tick; }
+    int tick() const { return current_tick; }
+    const Grid<uint8_t> &cells() const { return plane; }
+
+    bool seek(int tick);
+
+private:
+    struct Frame {
+        replay::FrameKind kind;
+        int tick;
+        const unsigned char* data;
+        size_t size;
+        size_t next;
+    };
+
+    MappedFile file;
+    bool ok = false;
+    Grid<uint8_t> plane{0, 0};
+    std::vector<replay::KeyframeEntry> keys;
+    size_t frames_begin = 0, frames_end = 0;
+    size_t cursor = 0;
+    int current_tick = -1;
+    int final_tick = 0;
+
+    bool parse(size_t at, Frame &out) const;
+    bool apply(const Frame &frame);
+    bool read_index();
+    void rebuild_index();
+};
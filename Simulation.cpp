@@ -1,74 +1,322 @@
 #include "Simulation.h"
-#include "Sand.h"
-#include "Algae.h"
 #include "HerbivoreFish.h"
 #include "PredatorFish.h"
-#include <cstdlib>
+#include <algorithm>
 using namespace std;
 
-Simulation::Simulation(int width_, int height_) : width(width_), height(height_) {
-    entities.resize(height);
-    for (auto& row : entities) {
-        row.resize(width);
-        for (auto& cell : row) {
-            cell = nullptr;
+Simulation::Simulation(int width_, int height_, uint64_t seed, int threads, const Params &params_,
+                       GridLayout layout)
+    : Simulation(width_, height_, seed, threads, params_, layout,
+                 Terrain(width_, height_, params_.seabed_depth)) {
+    populate(width * params.initial_algae / 100, width * params.initial_herbivores / 100,
+             width * params.initial_predators / 100);
+}
+
+// Пустой мир с заданным рельефом; используется и при загрузке.
+Simulation::Simulation(int width_, int height_, uint64_t seed, int threads, const Params &params_,
+                       GridLayout layout, Terrain terrain_)
+    : width(width_), height(height_), rng(seed), params(params_),
+      terrain(std::move(terrain_)),
+      algae(width_),
+      grid(width_, height_, EMPTY, SAND, layout),
+      index(width_, height_),
+      workers(threads) {
+    for (int x = 0; x < width; ++x)
+        for (int y = std::max(terrain.seabed(x), 0); y < height; ++y)
+            grid.set(x, y, SAND);
+}
+
+// Добавляет в мир случайно расставленные водоросли и рыб. Занятые клетки
+// пропускаются, а в столбце приживается один куст, так что итоговое число
+// объектов может быть меньше.
+void Simulation::populate(int plants, int herbivores, int predators) {
+    vector<uint32_t> r(3 * plants + 2 * herbivores + 2 * predators);
+    rng.fill(0, 0, STREAM_INIT, r.data(), r.size(), init_draws);
+    init_draws += r.size();
+    const uint32_t* next = r.data();
+
+    for (int i = 0; i < plants; ++i, next += 3) {
+        int x = next[0] % width;
+        int y = terrain.seabed(x) - 1 - next[1] % 3;
+        if (y >= 0 && grid(x, y) == EMPTY)
+            plant(x, y, params.algae_height + next[2] % params.algae_height_range);
+    }
+
+    for (int i = 0; i < herbivores; ++i, next += 2) {
+        int x = next[0] % width;
+        int y = next[1] % (height - 5);
+        if (grid(x, y) == EMPTY)
+            spawn(pools.herbivores.create(x, y, params.herbivore_hunger));
+    }
+
+    for (int i = 0; i < predators; ++i, next += 2) {
+        int x = next[0] % width;
+        int y = next[1] % (height - 5);
+        if (grid(x, y) == EMPTY)
+            spawn(pools.predators.create(x, y, params.predator_hunger));
+    }
+}
+
+// Окно копируется из сетки как есть: в ней уже лежит тип каждой клетки.
+void Simulation::snapshot(Snapshot &out) const {
+    out.tick = tick_count;
+    for (int y = 0; y < out.cells.height(); ++y) {
+        int wy = out.top + y;
+        auto dst = out.cells.row(y);
+        for (int x = 0; x < out.cells.width(); ++x) {
+            int wx = out.left + x;
+            dst[x] = grid.in_bounds(wx, wy) ? grid(wx, wy) : EMPTY;
         }
     }
+}
+
+// Тик идёт в две фазы. Сначала каждый вид обходит плотный список живых
+// объектов своего пула, а водоросли — свои столбцы: пачки списков и полосы
+// столбцов раздаются потокам, каждый выдаёт намерение, глядя только на
+// grid, и заявляет целевую клетку в claims (побеждает меньший key — индекс
+// исходной клетки). Затем commit последовательно применяет намерения
+// прямо в grid, вид за видом, так что результат не зависит от числа
+// потоков. Пустая вода и песок в тике не участвуют: работа тика зависит
+// от числа объектов, а не от площади мира.
+void Simulation::update() {
+    // Для стандартного набора параметров тик собран отдельно, с
+    // параметрами-константами.
+    if (params == Params{})
+        step<DefaultParams>();
+    else
+        step<RuntimeParams>();
+}
 
+template <class P>
+void Simulation::step() {
+    tick_count++;
+    claims.reset(pools.live() + width);
 
-    for (int y = height - 1; y > height - 3; --y)
-        for (int x = 0; x < width; ++x)
-            entities[y][x] = make_unique<Sand>(x, y);
+    batches[ALGAE] = (width + algae_columns - 1) / algae_columns;
+    batches[HERBIVORE] = (pools.herbivores.live() + batch_size - 1) / batch_size;
+    batches[PREDATOR] = (pools.predators.live() + batch_size - 1) / batch_size;
+    for (EntityType kind : {ALGAE, HERBIVORE, PREDATOR}) {
+        auto& lists = intents[kind];
+        // Пачка целиком помещается в заранее выделенный вектор.
+        for (size_t i = lists.size(); i < batches[kind]; ++i)
+            lists.emplace_back().reserve(kind == ALGAE ? algae_columns : batch_size);
+        for (size_t i = batches[kind]; i < lists.size(); ++i)
+            lists[i].clear();
+    }
 
-    for (int i = 0; i < width / 5; ++i) {
-        int x = rand() % width;
-        int y = height - 3 - (rand() % 3);
-        entities[y][x] = make_unique<Algae>(x, y);
+    TickContext ctx{grid, algae, index, rng, params, tick_count};
+    int jobs = static_cast<int>(batches[ALGAE] + batches[HERBIVORE] + batches[PREDATOR]);
+    {
+        PhaseTimer timer(metrics, PHASE_PROPOSE);
+        workers.run(jobs, [this, &ctx](int job) { propose_job<P>(job, ctx); });
     }
 
-    for (int i = 0; i < width / 10; ++i) {
-        int x = rand() % width;
-        int y = rand() % (height - 5);
-        entities[y][x] = make_unique<HerbivoreFish>(x, y);
+    commit<P>(ctx);
+
+    {
+        PhaseTimer timer(metrics, PHASE_SPAWN);
+        spawn_algae();
+        spawn_herbivore();
+        spawn_predator();
     }
 
-    for (int i = 0; i < width / 20; ++i) {
-        int x = rand() % width;
-        int y = rand() % (height - 5);
-        entities[y][x] = make_unique<PredatorFish>(x, y);
+    if (metrics)
+        metrics->end_tick(tick_count, algae.plants(), pools.herbivores.live(), pools.predators.live());
+}
+
+// Задание — полоса столбцов водорослей или пачка из batch_size объектов:
+// сначала водоросли, потом травоядные, потом хищники.
+template <class P>
+void Simulation::propose_job(size_t job, const TickContext &ctx) {
+    if (job < batches[ALGAE]) return propose_growth(job, ctx);
+    job -= batches[ALGAE];
+    if (job < batches[HERBIVORE]) return propose_batch<P>(pools.herbivores, job, ctx);
+    propose_batch<P>(pools.predators, job - batches[HERBIVORE], ctx);
+}
+
+template <class P, class T>
+void Simulation::propose_batch(const Pool<T> &pool, size_t batch, const TickContext &ctx) {
+    vector<Intent> &out = intents[T::kind][batch];
+    out.clear();
+    auto objects = pool.objects();
+    size_t end = min(objects.size(), (batch + 1) * batch_size);
+    for (size_t i = batch * batch_size; i < end; ++i) {
+        T &e = *objects[i];
+        Intent intent = e.template propose<P>(ctx);
+        // Номер клетки помещается в key: площадь мира меньше 2^32 (world_valid).
+        intent.key = static_cast<uint32_t>(e.y) * width + e.x;
+        out.push_back(intent);
+        if (intent.claims()) claim(intent);
     }
 }
 
-void Simulation::update() {
-    vector<vector<Entity*>> grid(height, vector<Entity*>(width, nullptr));
-    for (int y = 0; y < height; ++y)
-        for (int x = 0; x < width; ++x)
-            grid[y][x] = entities[y][x].get();
+// Куст растёт вверх, пока не достиг max_height и клетка над ним свободна;
+// иначе столбец засыпает до события, которое может это изменить.
+void Simulation::propose_growth(size_t band, const TickContext &ctx) {
+    vector<Intent> &out = intents[ALGAE][band];
+    out.clear();
+    int x0 = static_cast<int>(band) * algae_columns;
+    int x1 = min(x0 + algae_columns, width);
+    algae.for_each_awake(x0, x1, [&](int x) {
+        int top = algae.top(x);
+        if (!algae.growing(x) || !ctx.free(x, top - 1)) {
+            algae.sleep(x);
+            return;
+        }
+        Intent intent{nullptr, GROW, x, top - 1, static_cast<uint32_t>(top) * width + x};
+        out.push_back(intent);
+        claim(intent);
+    });
+}
+
+void Simulation::claim(const Intent &intent) {
+    claims.claim(static_cast<uint64_t>(intent.to_y) * width + intent.to_x, intent.key);
+}
+
+bool Simulation::won(const Intent &intent) const {
+    return intent.claims() &&
+           claims.won(static_cast<uint64_t>(intent.to_y) * width + intent.to_x, intent.key);
+}
+
+// Целевые клетки MOVE и GROW были пусты при propose, а жертва EAT к этому
+// моменту уже помечена, поэтому намерения можно применять прямо в grid.
+// Съеденная клетка водорослей срезает куст в algae.
+template <class P, class T>
+void Simulation::resolve_all(const TickContext &ctx) {
+    for (auto& batch : intents[T::kind]) {
+        for (const Intent &in : batch) {
+            T* e = static_cast<T*>(in.actor);
+            if (e->to_delete) continue;
+            if (in.action == DIE) {
+                e->to_delete = true;
+                continue;
+            }
+
+            bool granted = won(in);
+            e->template resolve<P>(in, granted, ctx);
+            if (e->to_delete) continue;
+
+            if (granted && (in.action == MOVE || in.action == EAT)) {
+                if (in.action == EAT) graze(in.to_x, in.to_y);
+                count(T::kind, in.action == EAT ? &SpeciesCounters::meals : &SpeciesCounters::moves);
+                int old_x = e->x, old_y = e->y;
+                vacate(old_x, old_y);
+                e->x = in.to_x;
+                e->y = in.to_y;
+                put(e->x, e->y, e->type);
+                index.move(e, old_x, old_y);
+            }
+        }
+    }
+}
 
-    vector<vector<Entity*>> new_grid(height, vector<Entity*>(width, nullptr));
+template <class P>
+void Simulation::commit(const TickContext &ctx) {
+    {
+        PhaseTimer timer(metrics, PHASE_RESOLVE);
+        // Хищники едят раньше травоядных: съеденная рыба уже не ест сама.
+        for (auto& batch : intents[PREDATOR])
+            for (const Intent &in : batch)
+                if (in.action == EAT && won(in))
+                    index.at(HERBIVORE, in.to_x, in.to_y)->to_delete = true;
 
-    for (int y = 0; y < height; ++y)
-        for (int x = 0; x < width; ++x)
-            if (grid[y][x] && !grid[y][x]->to_delete)
-                grid[y][x]->update(grid, new_grid);
+        resolve_all<P, PredatorFish>(ctx);
+        resolve_all<P, HerbivoreFish>(ctx);
 
-    std::vector<std::vector<std::unique_ptr<Entity>>> new_entities;
-    new_entities.resize(height);
+        // Рост, если куст в этом тике не объели.
+        for (auto& band : intents[ALGAE]) {
+            for (const Intent &in : band) {
+                if (won(in) && algae.top(in.to_x) - 1 == in.to_y) {
+                    algae.grow(in.to_x);
+                    put(in.to_x, in.to_y, ALGAE);
+                }
+            }
+        }
+    }
 
-    for (int y = 0; y < height; ++y) {
-        new_entities[y].reserve(width);
-        for (int x = 0; x < width; ++x) {
-            new_entities[y].emplace_back(nullptr);
+    // Клетку съеденного уже занял хищник; остальные мёртвые освобождают свою.
+    PhaseTimer timer(metrics, PHASE_REMOVE);
+    for (EntityType kind : {HERBIVORE, PREDATOR}) {
+        for (auto& batch : intents[kind]) {
+            for (const Intent &in : batch) {
+                Entity* e = in.actor;
+                if (!e->to_delete) continue;
+                if (grid(e->x, e->y) == e->type) vacate(e->x, e->y);
+                count(kind, &SpeciesCounters::deaths);
+                index.remove(e);
+                pools.destroy(e);
+            }
         }
     }
+}
+
+void Simulation::plant(int x, int y, int max_height) {
+    if (!algae.plant(x, y, max_height)) return;
+    put(x, y, ALGAE);
+    count(ALGAE, &SpeciesCounters::births);
+}
+
+void Simulation::graze(int x, int y) {
+    if (!algae.covers(x, y)) return;
+    for (int cy = algae.top(x); cy <= y; ++cy)
+        put(x, cy, EMPTY);
+    algae.graze(x, y);
+    if (!algae.alive(x)) count(ALGAE, &SpeciesCounters::deaths);
+}
+
+void Simulation::vacate(int x, int y) {
+    put(x, y, EMPTY);
+    algae.vacated(x, y);
+}
+
+void Simulation::insert(Entity* e) {
+    put(e->x, e->y, e->type);
+    index.insert(e);
+}
+
+void Simulation::spawn(Entity* e) {
+    e->id = next_id++;
+    insert(e);
+    count(e->type, &SpeciesCounters::births);
+}
+
+void Simulation::spawn_algae() {
+    uint32_t r[4];
+    rng.fill(tick_count, 0, STREAM_SPAWN_ALGAE, r, 4);
+    if (tick_count >= params.algae_spawn_until || static_cast<int>(r[0] % 100) >= params.algae_spawn) return;
+
+    int x = r[1] % width;
+    int y = terrain.seabed(x) - 1;
+    int min_dist = 1 + r[2] % 3;
+
+    for (int dx = -min_dist; dx <= min_dist; ++dx) {
+        int cx = x + dx;
+        if (cx >= 0 && cx < width && algae.covers(cx, y))
+            return;
+    }
 
-    entities = move(new_entities);
+    if (y >= 0 && grid(x, y) == EMPTY)
+        plant(x, y, params.algae_height + r[3] % params.algae_height_range);
 }
 
-vector<vector<Entity*>> Simulation::get_grid() const {
-    vector<vector<Entity*>> result(height, vector<Entity*>(width));
-    for (int y = 0; y < height; ++y)
-        for (int x = 0; x < width; ++x)
-            result[y][x] = entities[y][x].get();
-    return result;
+void Simulation::spawn_herbivore() {
+    uint32_t r[3];
+    rng.fill(tick_count, 0, STREAM_SPAWN_HERBIVORE, r, 3);
+    if (tick_count >= params.fish_spawn_until || static_cast<int>(r[0] % 100) >= params.herbivore_spawn) return;
+
+    int x = r[1] % width;
+    int y = r[2] % (height - 4);
+    if (grid(x, y) == EMPTY)
+        spawn(pools.herbivores.create(x, y, params.herbivore_hunger));
+}
+
+void Simulation::spawn_predator() {
+    uint32_t r[3];
+    rng.fill(tick_count, 0, STREAM_SPAWN_PREDATOR, r, 3);
+    if (tick_count >= params.fish_spawn_until || static_cast<int>(r[0] % 100) >= params.predator_spawn) return;
+
+    int x = r[1] % width;
+    int y = r[2] % (height - 4);
+    if (grid(x, y) == EMPTY)
+        spawn(pools.predators.create(x, y, params.predator_hunger));
 }
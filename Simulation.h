@@ -1,15 +1,104 @@
 #pragma once
+#include "AlgaeField.h"
+#include "ClaimTable.h"
 #include "Entity.h"
-#include <vector>
+#include "EntityPools.h"
+#include "Metrics.h"
+#include "SpatialIndex.h"
+#include "Terrain.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 class Simulation {
 public:
-    Simulation(int width_, int height_);
+    // layout — порядок клеток в чанках сетки (см. SparseGrid.h); на ход
+    // симуляции не влияет.
+    Simulation(int width_, int height_, uint64_t seed, int threads = 1, const Params &params_ = {},
+               GridLayout layout = LAYOUT_ROWS);
     void update();
-    std::vector<std::vector<Entity*>> get_grid() const;
+    void populate(int plants, int herbivores, int predators);
+    void snapshot(Snapshot &out) const;
+    const EntityGrid &get_grid() const { return grid; }
+    const Terrain &get_terrain() const { return terrain; }
+    const AlgaeField &get_algae() const { return algae; }
+    const EntityPools &get_pools() const { return pools; }
+    int get_tick() const { return tick_count; }
+    uint64_t get_seed() const { return rng.get_seed(); }
+    const Params &get_params() const { return params; }
+
+    // Контрольная точка (формат в Checkpoint.h). save пишет во временный
+    // файл и атомарно переименовывает его; load отображает файл в память.
+    // При ошибке false / nullptr.
+    bool save(const std::string &path) const;
+    static std::unique_ptr<Simulation> load(const std::string &path, int threads = 1,
+                                            GridLayout layout = LAYOUT_ROWS);
+
+    // Если журнал задан, в него в порядке применения дописываются все
+    // изменения клеток мира; очищает журнал его владелец.
+    void set_change_log(std::vector<CellChange>* log) { change_log = log; }
+    // Если задан, update меряет свои фазы и считает события видов.
+    void set_metrics(Metrics* metrics_) { metrics = metrics_; }
 
 private:
+    static constexpr int algae_columns = 256;
+    static_assert(algae_columns % 64 == 0, "полосы не должны делить слова маски AlgaeField");
+    static constexpr size_t batch_size = 256;
+
     int width, height;
-    std::vector<std::vector<std::unique_ptr<Entity>>> entities;
+    int tick_count = 0;
+    Rng rng;
+    Params params;
+    uint32_t next_id = 1;
+    uint32_t init_draws = 0;
+    EntityPools pools;
+    Terrain terrain;
+    AlgaeField algae;
+    EntityGrid grid;
+    ClaimTable claims;
+    SpatialIndex index;
+    // Намерения по пачкам списка пула, отдельно для каждого вида; у
+    // водорослей — по полосам из algae_columns столбцов. Векторы только
+    // растут, в этом тике используются первые batches[вид].
+    std::vector<std::vector<Intent>> intents[PREDATOR + 1];
+    size_t batches[PREDATOR + 1] = {};
+    ThreadPool workers;
+    std::vector<CellChange>* change_log = nullptr;
+    Metrics* metrics = nullptr;
+
+    // P — источник параметров (RuntimeParams или FixedParams, см. Params.h).
+    template <class P>
+    void step();
+    template <class P>
+    void propose_job(size_t job, const TickContext &ctx);
+    void propose_growth(size_t band, const TickContext &ctx);
+    template <class P, class T>
+    void propose_batch(const Pool<T> &pool, size_t batch, const TickContext &ctx);
+    template <class P, class T>
+    void resolve_all(const TickContext &ctx);
+    void claim(const Intent &intent);
+    bool won(const Intent &intent) const;
+    template <class P>
+    void commit(const TickContext &ctx);
+    Simulation(int width_, int height_, uint64_t seed, int threads, const Params &params_, GridLayout layout,
+               Terrain terrain_);
+
+    // Все изменения клеток мира идут через put: сетка и журнал повтора.
+    void put(int x, int y, EntityType type) {
+        grid.set(x, y, type);
+        if (change_log) change_log->push_back({x, y, static_cast<uint8_t>(type)});
+    }
+    void count(EntityType type, uint64_t SpeciesCounters::*event) {
+        if (metrics) ++(metrics->species(type).*event);
+    }
+    void plant(int x, int y, int max_height);
+    void graze(int x, int y);
+    void vacate(int x, int y);
+    void insert(Entity* e);
+    void spawn(Entity* e);
+    void spawn_algae();
+    void spawn_herbivore();
+    void spawn_predator();
 };
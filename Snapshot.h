@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include "Entity.h"
+#include "Grid.h"
+
+// Неизменяемый слепок окна мира для отрисовки: по байту EntityType на
+// клетку, cells(0, 0) соответствует клетке мира (left, top).
+struct Snapshot {
+    int tick = 0;
+    int left = 0, top = 0;
+    Grid<uint8_t> cells;
+
+    Snapshot(int width, int height) : cells(width, height, EMPTY) {}
+};
+
+// Изменение одной клетки мира; из них состоят дельты повторов.
+struct CellChange {
+    int x, y;
+    uint8_t type;
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Разреженная сетка из квадратных чанков по chunk×chunk клеток. Чанк, все
+// клетки которого пусты (равны empty), не хранится: чтение из него даёт
+// empty, запись выделяет чанк. Когда в чанке не остаётся занятых клеток,
+// он уходит в запас и переиспользуется следующей записью, так что память
+// ограничена пиковым числом населённых чанков, а не площадью мира.
+//
+// Вокруг мира лежит рамка шириной в клетку со значением border: читать
+// можно и x = -1..width, y = -1..height, так что соседей клетки мира
+// проверять на выход за границы не нужно. Отсутствующие чанки указывают
+// на общий пустой чанк, поэтому чтение — два обращения к памяти без
+// ветвлений.
+//
+// Внутри чанка клетки лежат построчно или в порядке Мортона (Z-кривая:
+// биты x и y чередуются, и соседи по вертикали чаще попадают в ту же
+// строку кэша). Порядок выбирается при создании; индекс клетки
+// складывается из двух маленьких таблиц, так что и он без ветвлений.
+enum GridLayout { LAYOUT_ROWS, LAYOUT_MORTON };
+
+template <class T, int chunk_shift = 4>
+class SparseGrid {
+public:
+    static constexpr int chunk = 1 << chunk_shift;
+    static_assert(chunk_shift <= 8, "индекс клетки в чанке — 16 бит");
+
+    SparseGrid(int width_, int height_, T empty_ = T(), T border = T(), GridLayout layout_ = LAYOUT_ROWS)
+        : w(width_), h(height_), empty(empty_), cell_order(layout_),
+          chunks_x((width_ + 2 + chunk - 1) >> chunk_shift),
+          chunks(static_cast<size_t>(chunks_x) * ((height_ + 2 + chunk - 1) >> chunk_shift), &blank) {
+        for (int i = 0; i < chunk; ++i) {
+            if (cell_order == LAYOUT_MORTON) {
+                column_offset[i] = spread(i);
+                row_offset[i] = static_cast<uint16_t>(spread(i) << 1);
+            }
+            else {
+                column_offset[i] = static_cast<uint16_t>(i);
+                row_offset[i] = static_cast<uint16_t>(i << chunk_shift);
+            }
+        }
+        std::fill(std::begin(blank.cells), std::end(blank.cells), empty);
+        for (int x = -1; x <= w; ++x) {
+            write(x, -1, border);
+            write(x, h, border);
+        }
+        for (int y = 0; y < h; ++y) {
+            write(-1, y, border);
+            write(w, y, border);
+        }
+        frame = live;
+    }
+
+    SparseGrid(const SparseGrid &) = delete;
+    SparseGrid &operator=(const SparseGrid &) = delete;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    GridLayout layout() const { return cell_order; }
+
+    bool in_bounds(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(w) &&
+               static_cast<unsigned>(y) < static_cast<unsigned>(h);
+    }
+
+    // x в [-1, width], y в [-1, height].
+    T operator()(int x, int y) const {
+        return chunks[chunk_of(x, y)]->cells[cell_of(x, y)];
+    }
+
+    // Только клетки мира: рамка не меняется.
+    void set(int x, int y, T value) { write(x, y, value); }
+
+    // Выделенные чанки, кроме выделенных под рамку при создании.
+    size_t live_chunks() const { return live - frame; }
+    size_t total_chunks() const { return chunks.size(); }
+
+private:
+    struct Chunk {
+        T cells[chunk * chunk];
+        int used = 0;
+    };
+
+    int w, h;
+    T empty;
+    GridLayout cell_order;
+    uint16_t column_offset[chunk], row_offset[chunk];
+    int chunks_x;
+    Chunk blank;
+    std::vector<Chunk*> chunks;
+    std::vector<std::unique_ptr<Chunk[]>> storage;
+    std::vector<Chunk*> spare;
+    size_t allocated = 0;
+    size_t live = 0, frame = 0;
+
+    // Координаты сдвинуты на клетку, чтобы рамка слева и сверху не
+    // уходила в отрицательные.
+    size_t chunk_of(int x, int y) const {
+        return static_cast<size_t>((y + 1) >> chunk_shift) * chunks_x + ((x + 1) >> chunk_shift);
+    }
+    int cell_of(int x, int y) const {
+        return row_offset[(y + 1) & (chunk - 1)] | column_offset[(x + 1) & (chunk - 1)];
+    }
+
+    // Биты i через один: 0b1011 -> 0b1000101.
+    static uint16_t spread(int i) {
+        uint16_t out = 0;
+        for (int bit = 0; bit < chunk_shift; ++bit)
+            out |= static_cast<uint16_t>(((i >> bit) & 1) << (2 * bit));
+        return out;
+    }
+
+    void write(int x, int y, T value) {
+        Chunk* &c = chunks[chunk_of(x, y)];
+        if (c == &blank) {
+            if (value == empty) return;
+            c = acquire();
+        }
+        T &cell = c->cells[cell_of(x, y)];
+        c->used += (value != empty) - (cell != empty);
+        cell = value;
+        if (c->used == 0) {
+            spare.push_back(c);
+            c = &blank;
+            --live;
+        }
+    }
+
+    // Чанки выделяются пачками не меньше уже выделенного, как растёт
+    // vector: пик заселённости, чуть превысивший прежний, память не
+    // трогает, а запас вмещает все чанки, так что возврат в него тоже.
+    Chunk* acquire() {
+        ++live;
+        if (spare.empty()) {
+            size_t n = std::max<size_t>(allocated, 16);
+            storage.emplace_back(new Chunk[n]);
+            allocated += n;
+            spare.reserve(allocated);
+            for (size_t i = n; i-- > 0;) {
+                Chunk* c = &storage.back()[i];
+                std::fill(std::begin(c->cells), std::end(c->cells), empty);
+                spare.push_back(c);
+            }
+        }
+        Chunk* c = spare.back();
+        spare.pop_back();
+        return c;
+    }
+};
@@ -0,0 +1,178 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+// Обходит клетки кольца ring вокруг (cx, cy) в пределах [0, nx) × [0, ny).
+template <class F>
+static void for_ring(int cx, int cy, int ring, int nx, int ny, F &&f) {
+    for (int iy = cy - ring; iy <= cy + ring; ++iy) {
+        if (iy < 0 || iy >= ny) continue;
+        bool edge_row = (iy == cy - ring || iy == cy + ring);
+        int step = edge_row || ring == 0 ? 1 : 2 * ring;
+        for (int ix = cx - ring; ix <= cx + ring; ix += step)
+            if (ix >= 0 && ix < nx) f(ix, iy);
+    }
+}
+
+// Расстояние от v до ближайшей точки отрезка [lo, lo + size).
+static int gap(int v, int lo, int size) {
+    return std::max({0, lo - v, v - (lo + size - 1)});
+}
+
+SpatialIndex::SpatialIndex(int width_, int height_, int bucket_size_)
+    : width(width_), height(height_), bucket_size(bucket_size_) {
+    buckets_x = (width + bucket_size - 1) / bucket_size;
+    buckets_y = (height + bucket_size - 1) / bucket_size;
+    blocks_x = (buckets_x + block - 1) / block;
+    blocks_y = (buckets_y + block - 1) / block;
+    // Корзины нужны только рыбам: песок и водоросли живут в своих слоях.
+    for (EntityType type : {HERBIVORE, PREDATOR})
+        blocks[type].assign(static_cast<size_t>(blocks_x) * blocks_y, nullptr);
+}
+
+Entity* SpatialIndex::bucket(EntityType type, int bx, int by) const {
+    const Block* b = blocks[type][(by / block) * blocks_x + bx / block];
+    return b ? b->buckets[(by % block) * block + bx % block] : nullptr;
+}
+
+// Блоки выделяются пачками не меньше уже выделенного (как в SparseGrid),
+// а запас вмещает их все, так что возврат блока память не выделяет.
+SpatialIndex::Block* SpatialIndex::acquire() {
+    if (spare.empty()) {
+        size_t n = std::max<size_t>(allocated, 4);
+        storage.emplace_back(new Block[n]);
+        allocated += n;
+        spare.reserve(allocated);
+        for (size_t i = n; i-- > 0;)
+            spare.push_back(&storage.back()[i]);
+    }
+    Block* b = spare.back();
+    spare.pop_back();
+    return b;
+}
+
+void SpatialIndex::add(Entity* e, int bx, int by) {
+    Block* &b = blocks[e->type][(by / block) * blocks_x + bx / block];
+    if (!b) b = acquire();
+    Entity* &first = b->buckets[(by % block) * block + bx % block];
+    e->bucket_prev = nullptr;
+    e->bucket_next = first;
+    if (first) first->bucket_prev = e;
+    first = e;
+    ++b->count;
+}
+
+void SpatialIndex::drop(Entity* e, int bx, int by) {
+    Block* &b = blocks[e->type][(by / block) * blocks_x + bx / block];
+    Entity* &first = b->buckets[(by % block) * block + bx % block];
+    if (e->bucket_prev) e->bucket_prev->bucket_next = e->bucket_next;
+    else first = e->bucket_next;
+    if (e->bucket_next) e->bucket_next->bucket_prev = e->bucket_prev;
+    if (--b->count == 0) {
+        spare.push_back(b);
+        b = nullptr;
+    }
+}
+
+void SpatialIndex::insert(Entity* e) {
+    if (blocks[e->type].empty()) return;
+    add(e, e->x / bucket_size, e->y / bucket_size);
+    ++counts[e->type];
+}
+
+void SpatialIndex::remove(Entity* e) {
+    if (blocks[e->type].empty()) return;
+    drop(e, e->x / bucket_size, e->y / bucket_size);
+    --counts[e->type];
+}
+
+void SpatialIndex::move(Entity* e, int old_x, int old_y) {
+    if (blocks[e->type].empty()) return;
+    int from_x = old_x / bucket_size, from_y = old_y / bucket_size;
+    int to_x = e->x / bucket_size, to_y = e->y / bucket_size;
+    if (from_x == to_x && from_y == to_y) return;
+    drop(e, from_x, from_y);
+    add(e, to_x, to_y);
+}
+
+void SpatialIndex::clear() {
+    for (auto& per_type : blocks) {
+        for (Block* &b : per_type) {
+            if (!b) continue;
+            std::fill(std::begin(b->buckets), std::end(b->buckets), nullptr);
+            b->count = 0;
+            spare.push_back(b);
+            b = nullptr;
+        }
+    }
+    std::fill(std::begin(counts), std::end(counts), 0);
+}
+
+Entity* SpatialIndex::at(EntityType type, int x, int y) const {
+    if (blocks[type].empty()) return nullptr;
+    for (Entity* e = bucket(type, x / bucket_size, y / bucket_size); e; e = e->bucket_next)
+        if (e->x == x && e->y == y) return e;
+    return nullptr;
+}
+
+void SpatialIndex::scan(Entity* first, int x, int y, Entity* &best, int &best_dist) const {
+    for (Entity* e = first; e; e = e->bucket_next) {
+        if (e->to_delete) continue;
+        int d = abs(e->x - x) + abs(e->y - y);
+        if (d < best_dist ||
+            (d == best_dist && best && (e->y < best->y || (e->y == best->y && e->x < best->x)))) {
+            best_dist = d;
+            best = e;
+        }
+    }
+}
+
+// Поиск идёт кольцами корзин вокруг (x, y). Любая клетка кольца ring
+// удалена от точки минимум на (ring - 1) * bucket_size + 1, поэтому
+// обход прекращается, как только это расстояние превысит найденное.
+// При равных расстояниях выбирается клетка с меньшими (y, x), как при
+// построчном обходе всей сетки.
+//
+// Если за block колец ничего не нашлось, добыча редкая и далеко: дальше
+// кольцами идут блоки, пустые блоки и корзины дальше найденного
+// пропускаются, так что цена поиска зависит от числа объектов, а не от
+// площади. Корзины ближних колец просматриваются повторно, на результат
+// это не влияет.
+Entity* SpatialIndex::find_nearest(EntityType type, int x, int y, int radius) const {
+    if (counts[type] == 0) return nullptr;
+    const auto& per_block = blocks[type];
+    Entity* best = nullptr;
+    int best_dist = radius + 1;
+
+    int bx = x / bucket_size, by = y / bucket_size;
+    int max_ring = std::max(buckets_x, buckets_y);
+    for (int ring = 0; ring < block; ++ring) {
+        if (ring > max_ring || (ring > 0 && (ring - 1) * bucket_size + 1 > best_dist)) return best;
+        for_ring(bx, by, ring, buckets_x, buckets_y,
+                 [&](int ix, int iy) {
+                     scan(bucket(type, ix, iy), x, y, best, best_dist);
+                 });
+    }
+
+    int span = block * bucket_size;
+    int max_block_ring = std::max(blocks_x, blocks_y);
+    for (int ring = 0; ring <= max_block_ring; ++ring) {
+        if (ring > 0 && (ring - 1) * span + 1 > best_dist) break;
+        for_ring(x / span, y / span, ring, blocks_x, blocks_y, [&](int kx, int ky) {
+            const Block* k = per_block[ky * blocks_x + kx];
+            if (!k) return;
+            if (gap(x, kx * span, span) + gap(y, ky * span, span) > best_dist) return;
+            int x1 = std::min((kx + 1) * block, buckets_x), y1 = std::min((ky + 1) * block, buckets_y);
+            for (int iy = ky * block; iy < y1; ++iy)
+                for (int ix = kx * block; ix < x1; ++ix) {
+                    Entity* first = k->buckets[(iy - ky * block) * block + ix - kx * block];
+                    if (!first ||
+                        gap(x, ix * bucket_size, bucket_size) + gap(y, iy * bucket_size, bucket_size) > best_dist)
+                        continue;
+                    scan(first, x, y, best, best_dist);
+                }
+        });
+    }
+    return best;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Entity.h"
+#include <memory>
+#include <vector>
+
+class SpatialIndex {
+public:
+    SpatialIndex(int width_, int height_, int bucket_size_ = 8);
+
+    SpatialIndex(const SpatialIndex &) = delete;
+    SpatialIndex &operator=(const SpatialIndex &) = delete;
+
+    void insert(Entity* e);
+    void remove(Entity* e);
+    void move(Entity* e, int old_x, int old_y);
+    void clear();
+    Entity* find_nearest(EntityType type, int x, int y, int radius) const;
+    // Объект вида type в клетке (x, y) или nullptr.
+    Entity* at(EntityType type, int x, int y) const;
+
+private:
+    // Корзины сгруппированы в блоки block×block со счётчиком объектов:
+    // дальний поиск перешагивает пустые блоки целиком. Блок выделяется,
+    // когда в него попадает первый объект, и уходит в запас, когда
+    // последний его покидает, так что память растёт с заселённой
+    // площадью, а не со всей. Корзина — список через bucket_next
+    // объектов, поэтому перемещение рыбы память не выделяет.
+    static constexpr int block = 8;
+
+    struct Block {
+        Entity* buckets[block * block] = {};
+        int count = 0;
+    };
+
+    int width, height;
+    int bucket_size;
+    int buckets_x, buckets_y;
+    int blocks_x, blocks_y;
+    std::vector<Block*> blocks[PREDATOR + 1];   // nullptr — блок пуст
+    std::vector<std::unique_ptr<Block[]>> storage;
+    std::vector<Block*> spare;
+    size_t allocated = 0;
+    size_t counts[PREDATOR + 1] = {};
+
+    // Первый объект корзины (bx, by) вида type; nullptr, если она пуста.
+    Entity* bucket(EntityType type, int bx, int by) const;
+    void add(Entity* e, int bx, int by);
+    void drop(Entity* e, int bx, int by);
+    Block* acquire();
+    void scan(Entity* first, int x, int y, Entity* &best, int &best_dist) const;
+};
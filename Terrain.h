@@ -0,0 +1,17 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+// Неподвижный рельеф дна: только высоты. Песок в столбце x лежит от
+// seabed(x) до нижней строки; Simulation записывает его в сетку как SAND,
+// и столкновения проверяются только по сетке.
+class Terrain {
+public:
+    Terrain(int width, int height, int depth) : top(width, height - depth) {}
+    explicit Terrain(std::vector<int> top_) : top(std::move(top_)) {}
+
+    int seabed(int x) const { return top[x]; }
+
+private:
+    std::vector<int> top;
+};
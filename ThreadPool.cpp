@@ -0,0 +1,67 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads) {
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back([this] { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers)
+        t.join();
+}
+
+void ThreadPool::drain(const std::function<void(int)> &job, int jobs) {
+    for (int i = next_job.fetch_add(1); i < jobs; i = next_job.fetch_add(1))
+        job(i);
+}
+
+void ThreadPool::run(int jobs, const std::function<void(int)> &job) {
+    if (workers.empty()) {
+        for (int i = 0; i < jobs; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &job;
+        job_count = jobs;
+        next_job = 0;
+        busy = static_cast<int>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    drain(job, jobs);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    current = nullptr;
+}
+
+void ThreadPool::worker_loop() {
+    unsigned seen = 0;
+    while (true) {
+        const std::function<void(int)>* job;
+        int jobs;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            job = current;
+            jobs = job_count;
+        }
+
+        drain(*job, jobs);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            done.notify_one();
+    }
+}
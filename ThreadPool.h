@@ -0,0 +1,35 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Фиксированный набор рабочих потоков. run() раздаёт задания 0..jobs-1
+// и возвращается, когда все они выполнены; вызывающий поток тоже работает.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+    void run(int jobs, const std::function<void(int)> &job);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)>* current = nullptr;
+    int job_count = 0;
+    std::atomic<int> next_job{0};
+    int busy = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+
+    void worker_loop();
+    void drain(const std::function<void(int)> &job, int jobs);
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Фиксированный шаг симуляции отдельно от частоты кадров:
+//
+//     while (running) {
+//         while (scheduler.tick_due()) sim.update();
+//         if (scheduler.frame_due()) draw();
+//         scheduler.wait();
+//     }
+//
+// Скорость tick_rate тиков в секунду; 0 — сколько успеем, тогда между
+// кадрами идут тики без пауз. Когда подходит время кадра, tick_due()
+// отдаёт управление, и промежуточные состояния просто не рисуются. Если
+// отрисовка медленнее частоты кадров, после каждого кадра симуляции всё
+// равно остаётся хотя бы полкадра, то есть пропускаются кадры, а не тики.
+// Если не успевает сама симуляция, отставание больше max_lag забывается,
+// а не догоняется. Не потокобезопасен.
+class TickScheduler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    TickScheduler(double tick_rate_, double frame_rate)
+        : frame_period(period(frame_rate)) {
+        set_tick_rate(tick_rate_);
+    }
+
+    double tick_rate() const { return rate; }
+    void set_tick_rate(double rate_) {
+        if (rate_ == rate) return;
+        rate = std::max(rate_, 0.0);
+        if (rate > 0) step = period(rate);
+        next_tick = clock::now();
+    }
+
+    bool paused() const { return is_paused; }
+    void set_paused(bool paused_) {
+        if (is_paused && !paused_) next_tick = clock::now();
+        is_paused = paused_;
+    }
+
+    bool tick_due() {
+        clock::time_point now = clock::now();
+        frame_done(now);
+        if (is_paused || now >= next_frame) return false;
+        if (rate == 0) return true;
+        if (now < next_tick) return false;
+        next_tick = std::max(next_tick + step, now - max_lag);
+        return true;
+    }
+
+    bool frame_due() {
+        clock::time_point now = clock::now();
+        if (now < next_frame) return false;
+        next_frame += frame_period;
+        if (next_frame <= now) next_frame = now + frame_period;
+        drawn = true;
+        return true;
+    }
+
+    // Спит до ближайшего тика или кадра.
+    void wait() {
+        frame_done(clock::now());
+        clock::time_point until = next_frame;
+        if (!is_paused) {
+            if (rate == 0) return;
+            until = std::min(until, next_tick);
+        }
+        std::this_thread::sleep_until(until);
+    }
+
+private:
+    static constexpr clock::duration max_lag = std::chrono::milliseconds(250);
+
+    // Первый вызов после отрисованного кадра: оставляет симуляции
+    // хотя бы полкадра до следующего.
+    void frame_done(clock::time_point now) {
+        if (!drawn) return;
+        drawn = false;
+        next_frame = std::max(next_frame, now + frame_period / 2);
+    }
+
+    static clock::duration period(double per_second) {
+        return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / per_second));
+    }
+
+    double rate = -1;
+    bool is_paused = false;
+    bool drawn = false;
+    clock::duration step{}, frame_period;
+    clock::time_point next_tick = clock::now(), next_frame = clock::now();
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+
+// Тройной буфер без блокировок для одного писателя и одного читателя.
+// Писатель заполняет write_buffer() и публикует его; читатель всегда
+// получает последний опубликованный целиком буфер. Никто никого не ждёт,
+// память выделяется один раз.
+template <class T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T &init) : buffers{init, init, init} {}
+
+    T &write_buffer() { return buffers[back]; }
+
+    void publish() {
+        back = middle.exchange(back | fresh, std::memory_order_acq_rel) & index_mask;
+    }
+
+    // Ссылка действительна до следующего вызова read().
+    const T &read() {
+        if (middle.load(std::memory_order_relaxed) & fresh)
+            front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+        return buffers[front];
+    }
+
+private:
+    static constexpr int fresh = 4;
+    static constexpr int index_mask = 3;
+
+    T buffers[3];
+    int back = 0;
+    int front = 1;
+    std::atomic<int> middle{2};
+};